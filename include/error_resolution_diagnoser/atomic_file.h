@@ -0,0 +1,11 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_ATOMIC_FILE_H
+#define ERROR_RESOLUTION_DIAGNOSER_ATOMIC_FILE_H
+
+#include <string>
+
+// Replaces a file with new contents so readers only ever see the old or the new file. The contents go to a
+// uniquely named temporary file next to it, are flushed to disk and renamed over the target, so several
+// processes writing the same path at once never share a temporary file and a crash never leaves it truncated.
+bool write_file_atomic(const std::string &, const std::string &);
+
+#endif
@@ -13,7 +13,16 @@
 #include <algorithm>
 #include <ros/ros.h>
 #include <boost/filesystem.hpp>
-#include <boost/date_time.hpp>
+#include <error_resolution_diagnoser/telemetry.h>
+#include <error_resolution_diagnoser/event_record.h>
+#include <error_resolution_diagnoser/timestamp.h>
+#include <error_resolution_diagnoser/json_writer.h>
+#include <error_resolution_diagnoser/http_client_pool.h>
+#include <error_resolution_diagnoser/classification_cache.h>
+#include <error_resolution_diagnoser/single_flight.h>
+#include <error_resolution_diagnoser/circuit_breaker.h>
+#include <error_resolution_diagnoser/request_batcher.h>
+#include <error_resolution_diagnoser/classification_index.h>
 
 class BackendApi
 {
@@ -28,7 +37,6 @@ class BackendApi
   std::string log_name;                  // Stores the directory along with log name
   std::string log_ext;                   // Stores the log file extension type
   int log_id;                            // Incremental log id #
-  std::string msg_resp;                  // Stores the ECS response
   std::string ecs_api_host;              // ENV variable that specifies the host for the ECS API
   std::string ecs_api_endpoint;          // Stores the endpoint for the ECS API. Based on AGENT_TYPE this is automatically configured.
   std::string ecs_robot_model;           // ENV variable that specifies the type of robot. Currently use Turtlebot3 for any /move_base navigation stack.
@@ -36,15 +44,33 @@ class BackendApi
   std::vector<std::string> node_list;    // List of nodes to include messages by
   std::vector<std::string> node_ex_list; // List of nodes to exclude messages by
   std::string diag_setting;              // Keeps track of the diagnostics setting on or off
+  std::unique_ptr<HttpClientPool> ecs_pool; // Keep-alive clients to the ECS API host, only created when classification is on
+  std::unique_ptr<ClassificationCache> ecs_cache; // Recent ECS answers, only created when classification is on
+  std::unique_ptr<CircuitBreaker> ecs_breaker; // Pauses ECS queries while the API keeps failing, only created when classification is on
+  std::unique_ptr<CircuitBreaker> post_breaker; // Pauses POST requests while the endpoint keeps failing
+  SingleFlight<web::json::value> ecs_flight; // ECS queries in flight by message text, shared by concurrent lookups of the same text
+  std::unique_ptr<ClassificationIndex> ecs_index; // Table snapshot that classifies offline, only created when ECS_TABLE_FILE is set
+  std::unique_ptr<RequestBatcher> ecs_batcher; // Groups ECS queries into batch requests, only created when ECS_BATCH_SIZE is above 1
+  std::string ecs_cache_file;            // File the ECS answers are saved to for the next run
 
 public:
   BackendApi();
   ~BackendApi();
   void check_environment();                                                 // Utility method to pull environment variables and set defaults
-  pplx::task<void> post_event_log(web::json::value);                        // A configurable downstream push method
-  void push_status(bool, web::json::value);                                 // Pushes appropriate status data
-  void push_event_log(std::vector<std::vector<std::string>>);               // Create and push single JSON record payload data for downstream consumption
-  web::json::value create_event_log(std::vector<std::vector<std::string>>); // Create JSON "multiple record" payload data for downstream consumption
-  pplx::task<void> query_error_classification(std::string);                 // Query error classification database table
-  web::json::value check_error_classification(std::string);                 // Entry point for error classification
+  pplx::task<void> post_event_log(std::string);                             // A configurable downstream push method for a serialized JSON payload
+  void push_status(bool, const Telemetry &);                                // Pushes appropriate status data
+  void push_event_log(const EventRecord &);                                 // Create and push single JSON record payload data for downstream consumption
+  web::json::value create_event_log(const std::vector<EventRecord> &);      // Create JSON "multiple record" payload data for downstream consumption
+  pplx::task<web::json::value> query_error_classification(std::string);     // Query error classification database table, resolves to the response document
+  pplx::task<std::vector<web::json::value>> query_error_classification_batch(const std::vector<std::string> &); // Query several texts in one request, resolves to one response document per text
+  pplx::task<web::json::value> classify_async(std::string);                 // Classification of a message text through the cache, resolves to null if there is none
+  web::json::value check_error_classification(std::string);                 // Blocking entry point for error classification
+  HttpClientPool *get_ecs_pool();                                           // Pool of ECS clients, nullptr in ROS mode
+  BreakerStats get_ecs_breaker_stats();                                     // State and counters of the ECS circuit breaker
+  BreakerStats get_post_breaker_stats();                                    // State and counters of the POST circuit breaker
+  RequestBatcher *get_ecs_batcher();                                        // Batcher of ECS queries, nullptr when batching is off
+  ClassificationIndex *get_ecs_index();                                     // Offline classification table, nullptr when classifying through the API
+  std::string get_agent_type();                                             // Mode the configuration resolved to, ROS if it could not classify
+  ClassificationStats get_classification_stats();                           // Hit and miss counters of the classification cache
+  bool save_classification_cache();                                         // Save the classification cache for the next run, false if it could not be written
 };
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_CIRCUIT_BREAKER_H
+#define ERROR_RESOLUTION_DIAGNOSER_CIRCUIT_BREAKER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+enum class BreakerState : uint8_t
+{
+    CLOSED = 0,
+    OPEN = 1,
+    HALF_OPEN = 2
+};
+
+struct BreakerStats
+{
+    BreakerState state;                  // Current state
+    uint64_t successes;                  // Requests that got a response
+    uint64_t failures;                   // Requests that failed or timed out
+    uint64_t rejected;                   // Requests not sent because the breaker was open
+    uint64_t trips;                      // Number of times the breaker opened
+    std::chrono::milliseconds timeout;   // Timeout currently applied to requests
+};
+
+class CircuitBreaker
+{
+
+    // This class provides a circuit breaker and an adaptive timeout for one HTTP endpoint.
+    // After a number of consecutive failures the breaker opens and requests are rejected without being sent. Once the
+    // open time has passed a single probe request is let through (half-open). A successful probe closes the breaker,
+    // a failed one opens it again for twice as long, up to 16 times the base open time.
+    // The timeout is a multiple of the 99th percentile of recent response times, kept between a tenth of the maximum and
+    // the maximum. It widens after each failure so a backend that got slower is not locked out.
+
+    static const size_t LATENCY_WINDOW = 64;     // Number of recent response times kept
+    static const size_t MIN_SAMPLES = 16;        // Response times needed before the timeout adapts
+
+    std::string name;                            // Endpoint name used in messages
+    size_t failure_threshold;                    // Consecutive failures that open the breaker
+    std::chrono::milliseconds base_open_time;    // Time the breaker stays open after it trips
+    std::chrono::milliseconds open_time;         // Time the breaker stays open this time
+    std::chrono::milliseconds min_timeout;       // Lower bound of the adaptive timeout
+    std::chrono::milliseconds max_timeout;       // Upper bound of the adaptive timeout, used until enough samples are in
+    std::chrono::milliseconds current_timeout;   // Timeout currently applied to requests
+    BreakerState state;                          // Current state
+    size_t consecutive_failures;                 // Failures since the last success
+    std::chrono::steady_clock::time_point opened_at;     // Time the breaker last opened
+    std::chrono::steady_clock::time_point probe_started; // Time the half-open probe was let through
+    std::vector<uint32_t> latencies;             // Recent response times in milliseconds, used as a ring
+    size_t next_latency;                         // Slot of the next response time
+    BreakerStats stats;                          // Counters
+    std::mutex breaker_mutex;                    // Guards everything above
+
+    void adapt_timeout();                        // Recompute the timeout from recent response times
+
+public:
+    CircuitBreaker(std::string, size_t, std::chrono::milliseconds, std::chrono::milliseconds);
+    bool allow();                                // Whether a request may be sent now. Counts a rejection if not.
+    void record_success(std::chrono::milliseconds); // Record a response and its response time
+    void record_failure();                       // Record a failed or timed out request
+    std::chrono::milliseconds timeout();         // Timeout to apply to the next request
+    BreakerState get_state();                    // Current state
+    BreakerStats get_stats();                    // Counters, state and timeout
+};
+
+#endif
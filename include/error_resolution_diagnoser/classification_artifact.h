@@ -0,0 +1,43 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_CLASSIFICATION_ARTIFACT_H
+#define ERROR_RESOLUTION_DIAGNOSER_CLASSIFICATION_ARTIFACT_H
+
+#include <cpprest/json.h>
+#undef U
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+class ClassificationArtifact
+{
+
+    // This class provides read-only access to a compiled classification table. The artifact is written once offline
+    // by compile_classification_table and holds a header, an open addressing hash index on error_text, fixed size
+    // row records and a string pool with the texts and serialized rows. Opening it maps the file and checks the
+    // header, so startup time does not depend on the table size, and every agent on a host shares the same pages.
+    // The mapping is never written, so lookups need no locking.
+
+    const uint8_t *base;      // Start of the mapping, nullptr when nothing is mapped
+    size_t length;            // Bytes mapped
+    const void *slots;        // Hash index, a power of two slots
+    uint64_t slot_count;      // Number of slots
+    const void *rows;         // Row records
+    uint64_t row_count;       // Number of rows
+    const char *pool;         // String pool
+    uint64_t pool_size;       // Bytes in the string pool
+
+    void close();             // Unmap the artifact
+
+public:
+    ClassificationArtifact();
+    ~ClassificationArtifact();
+    ClassificationArtifact(const ClassificationArtifact &) = delete;
+    ClassificationArtifact &operator=(const ClassificationArtifact &) = delete;
+    static bool is_artifact(const std::string &);                 // Whether a file starts like a compiled artifact
+    static bool write(const std::string &, const std::string &,
+                      const std::unordered_map<std::string, web::json::value> &); // Compile rows by error text for a robot model into an artifact
+    size_t open(const std::string &, const std::string &);        // Map the artifact compiled for a robot model, returns its rows
+    bool lookup(const std::string &, web::json::value &) const;   // Row classifying the text, false if the text is not in the table
+    size_t size() const;                                          // Number of rows mapped
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_CLASSIFICATION_CACHE_H
+#define ERROR_RESOLUTION_DIAGNOSER_CLASSIFICATION_CACHE_H
+
+#include <cpprest/json.h>
+#undef U
+#include <string>
+#include <list>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <unordered_map>
+
+struct ClassificationStats
+{
+    size_t entries;     // Number of cached lookups
+    uint64_t hits;      // Lookups answered with a cached classification
+    uint64_t negative;  // Lookups answered with a cached "not in the table"
+    uint64_t misses;    // Lookups that had to go to the API
+    uint64_t evictions; // Entries dropped to stay within capacity
+    uint64_t coalesced; // Misses that joined a query already in flight instead of sending their own
+};
+
+class ClassificationCache
+{
+
+    // This class provides a bounded LRU cache of error classification lookups keyed on robot model and message text.
+    // Classifications and "not in the table" answers are both cached, each with its own TTL, so text that is not
+    // classified is not queried again on every message. Entries belong to the API configuration the cache is built with.
+    // The cache can be saved to a file and loaded back so a restarted agent starts warm.
+
+    struct CacheEntry
+    {
+        std::string key;                                  // Robot model and message text
+        web::json::value value;                           // Classification, null when the text is not in the table
+        std::chrono::steady_clock::time_point expiry;     // Entry is stale after this time
+    };
+
+    size_t capacity;                                                          // Maximum number of entries
+    std::chrono::milliseconds hit_ttl;                                        // Lifetime of a cached classification
+    std::chrono::milliseconds miss_ttl;                                       // Lifetime of a cached "not in the table"
+    std::string config;                                                       // API configuration the entries are fetched with
+    std::list<CacheEntry> entries;                                            // Entries, most recently used at the front
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> index;   // Entries by key
+    ClassificationStats stats;                                                // Counters
+    std::mutex cache_mutex;                                                   // Guards everything above
+
+    static std::string make_key(const std::string &, const std::string &);   // Key of a robot model and message text
+
+public:
+    ClassificationCache(const std::string &, size_t, std::chrono::milliseconds, std::chrono::milliseconds);
+    bool lookup(const std::string &, const std::string &, web::json::value &); // Cached value for robot model and text. Counts a hit or miss.
+    void store(const std::string &, const std::string &, const web::json::value &); // Cache an API answer, null for "not in the table"
+    void clear();                                                             // Drop every entry
+    bool save(const std::string &);                                           // Write unexpired entries and the configuration to a file
+    size_t load(const std::string &);                                         // Read entries saved with the current configuration, returns how many
+    ClassificationStats get_stats();                                          // Counters and current size
+};
+
+#endif
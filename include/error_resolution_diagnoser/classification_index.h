@@ -0,0 +1,33 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_CLASSIFICATION_INDEX_H
+#define ERROR_RESOLUTION_DIAGNOSER_CLASSIFICATION_INDEX_H
+
+#include <cpprest/json.h>
+#undef U
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <error_resolution_diagnoser/classification_artifact.h>
+
+class ClassificationIndex
+{
+
+    // This class provides an in-memory index of an exported error classification table, so message texts are
+    // classified without a network round trip. The snapshot is a JSON array of table rows, or an object with the
+    // rows under "data" like an API answer. Rows are the same objects the API returns and are keyed on their exact
+    // error_text. Rows with a robot_model other than the configured one are skipped. A snapshot compiled into an
+    // artifact by compile_classification_table is mapped instead of parsed.
+    // The index is filled once by load and only read afterwards, so lookups need no locking.
+
+    std::unordered_map<std::string, web::json::value> rows; // Table rows by error text
+    std::unique_ptr<ClassificationArtifact> artifact;      // Mapped artifact, null when the snapshot was parsed
+
+public:
+    ClassificationIndex();
+    size_t load(const std::string &, const std::string &);      // Index the rows of a snapshot file for a robot model, returns how many
+    bool lookup(const std::string &, web::json::value &) const; // Row classifying the text, false if the text is not in the table
+    size_t size() const;                                        // Number of rows indexed
+    bool is_mapped() const;                                     // Whether rows come from a mapped artifact
+    const std::unordered_map<std::string, web::json::value> &get_rows() const; // Rows parsed from a snapshot, empty when mapped
+};
+
+#endif
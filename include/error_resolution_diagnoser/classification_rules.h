@@ -0,0 +1,29 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_CLASSIFICATION_RULES_H
+#define ERROR_RESOLUTION_DIAGNOSER_CLASSIFICATION_RULES_H
+
+#include <cpprest/json.h>
+#undef U
+#include <string>
+#include <vector>
+#include <error_resolution_diagnoser/rule_matcher.h>
+
+class ClassificationRules
+{
+
+    // This class provides local classification rules maintained alongside the agent. The rules file is a JSON array
+    // of rule objects with a "pattern", how it must "match" (contains, prefix, suffix, exact or glob, contains if
+    // absent) and the "severity" of messages it matches. Rules may also carry the compounding_flag, error_module,
+    // error_source and error_text of an ECS row, defaulting to false, 'Null', 'Null' and the pattern itself.
+    // A message is classified by the first rule in the file that matches it, as the row that rule stands for.
+
+    RuleMatcher matcher;                // Automata of every rule pattern
+    std::vector<web::json::value> rows; // Classification row of each rule, by rule id
+
+public:
+    ClassificationRules();
+    size_t load(const std::string &);                     // Compile the rules of a rules file, returns how many
+    bool classify(const std::string &, web::json::value &); // Row of the first rule matching the text, false if none does
+    size_t size() const;                                  // Number of rules compiled
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_EVENT_ID_H
+#define ERROR_RESOLUTION_DIAGNOSER_EVENT_ID_H
+
+#include <string>
+#include <random>
+#include <cstdint>
+
+enum class EventIdFormat : uint8_t
+{
+    UUID4 = 4, // Random UUID
+    UUID7 = 7  // Time ordered UUID, 48-bit Unix millisecond timestamp followed by a per thread sequence and random bits
+};
+
+class EventIdGenerator
+{
+
+    // This class provides RFC 4122 / RFC 9562 UUIDs for event IDs. The random engine is seeded from the OS entropy
+    // source once per generator and IDs are formatted into a fixed buffer. Use local() to get the generator of the
+    // calling thread so no locking is needed.
+
+    std::mt19937_64 engine; // Random engine, seeded once
+    uint64_t last_ms;       // Timestamp of the last UUIDv7
+    uint16_t sequence;      // 12-bit sequence within last_ms, keeps UUIDv7 from one thread strictly increasing
+
+public:
+    EventIdGenerator();
+    EventIdGenerator(const EventIdGenerator &) = delete;
+    EventIdGenerator &operator=(const EventIdGenerator &) = delete;
+    void next_bytes(EventIdFormat, uint64_t, uint8_t *);    // Fill 16 bytes with a UUID, timestamp in ms is used for UUIDv7
+    std::string next(EventIdFormat);                        // New UUID in canonical text form
+    static std::string format(const uint8_t *);             // Canonical 36 character text form of 16 bytes
+    static EventIdGenerator &local();                       // Generator of the calling thread
+    static EventIdFormat format_from_env();                 // Read EVENT_ID_FORMAT, defaults to UUID4
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_EVENT_RECORD_H
+#define ERROR_RESOLUTION_DIAGNOSER_EVENT_RECORD_H
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <error_resolution_diagnoser/timestamp.h>
+
+enum class EventLevel : uint8_t
+{
+    DEBUG = 1,
+    INFO = 2,
+    WARN = 4,
+    ERROR = 8,
+    FATAL = 16
+};
+
+enum class Compounding : uint8_t
+{
+    UNSET = 0, // Not classified, reported as "Null"
+    NO = 1,
+    YES = 2
+};
+
+std::shared_ptr<const std::string> intern_string(const std::string &); // Single shared copy of a module or source name, a private one once the table is full
+
+struct EventRecord
+{
+    // One record of an event log. Level and compounding flag are typed, and module, source, telemetry and event ID
+    // are shared handles so building a record copies as little as possible.
+
+    Timestamp time;                               // UTC time the record was created
+    EventLevel level;                             // Severity of the record
+    Compounding compounding;                      // Compounding flag from classification
+    std::shared_ptr<const std::string> module;    // Module name, interned from classification
+    std::shared_ptr<const std::string> source;    // Source name, interned from classification or the node name
+    std::string message;                          // Raw message text
+    std::string description;                      // Description from classification
+    std::string resolution;                       // Resolution from classification
+    std::shared_ptr<const std::string> telemetry; // Serialized telemetry, shared by every record of the same pose version
+    std::shared_ptr<const std::string> event_id;  // UUID shared by every record of an event
+
+    EventRecord();
+    bool creates_ticket() const;          // Errors that are not compounding create a ticket
+    std::string time_str() const;         // ISO 8601 time
+    std::string level_str() const;        // Numeric level as text
+    std::string compounding_str() const;  // "true", "false" or "Null"
+};
+
+#endif
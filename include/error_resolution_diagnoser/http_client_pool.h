@@ -0,0 +1,91 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_HTTP_CLIENT_POOL_H
+#define ERROR_RESOLUTION_DIAGNOSER_HTTP_CLIENT_POOL_H
+
+#include <cpprest/http_client.h>
+#undef U
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <utility>
+
+class HttpClientPool
+{
+
+    // This class provides a bounded pool of long-lived HTTP clients to one host. Each cpprest client keeps its
+    // connections alive between requests, so reusing clients turns a lookup into one request/response on a warm
+    // connection instead of a new TCP and TLS handshake. Clients that saw a transport error are dropped instead
+    // of returned, and clients left idle longer than the idle timeout are reaped. Changing the timeout replaces
+    // clients as they come back, since a cpprest client keeps the configuration it was created with.
+    // Asynchronous callers waiting on an exhausted pool park a completion event instead of a thread, and are
+    // handed the next client that comes back before any blocking caller.
+
+    struct PooledClient
+    {
+        std::unique_ptr<web::http::client::http_client> client; // Client with its own keep-alive connections
+        std::chrono::steady_clock::time_point last_used;         // Time the client was last returned to the pool
+        uint64_t generation;                                     // Configuration the client was created with
+    };
+
+    std::string host;                                  // Base URI every client connects to
+    web::http::client::http_client_config config;      // Configuration shared by all clients
+    size_t max_clients;                                // Upper bound on clients in use plus idle
+    std::chrono::milliseconds idle_timeout;            // Idle clients older than this are closed
+    std::mutex pool_mutex;                             // Guards everything below
+    std::condition_variable pool_cv;                   // Signalled when a client is returned or dropped
+    std::vector<PooledClient> idle;                    // Clients ready to use, most recently used at the back
+    size_t open_clients;                               // Clients in use plus idle
+    uint64_t created;                                  // Number of clients created so far
+    uint64_t discarded;                                // Number of clients dropped after an error
+    uint64_t generation;                               // Bumped on every configuration change
+
+    void reap_locked(std::chrono::steady_clock::time_point); // Close idle clients past the idle timeout
+    bool take_locked(PooledClient &);                        // Reuse an idle client or create one, false if the pool is exhausted
+
+public:
+    class Lease
+    {
+        // Exclusive use of one pooled client, returned to the pool when the lease is destroyed
+
+        HttpClientPool *pool;
+        PooledClient entry;
+        bool healthy;
+
+    public:
+        Lease(HttpClientPool *, PooledClient);
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        ~Lease();
+        web::http::client::http_client &client(); // Leased client
+        void discard();                           // Mark the client broken so it is not reused
+    };
+
+private:
+    typedef std::vector<std::pair<pplx::task_completion_event<std::shared_ptr<Lease>>, std::shared_ptr<Lease>>> ReadyWaiters;
+
+    std::deque<pplx::task_completion_event<std::shared_ptr<Lease>>> waiters; // Asynchronous callers waiting for a client, oldest first, guarded by pool_mutex
+
+    void serve_waiters_locked(ReadyWaiters &); // Lease clients to waiting asynchronous callers while there are any
+    static void complete(ReadyWaiters &);      // Hand leases to their callers, outside the lock
+
+public:
+    HttpClientPool(std::string, web::http::client::http_client_config, size_t, std::chrono::milliseconds);
+    HttpClientPool(const HttpClientPool &) = delete;
+    HttpClientPool &operator=(const HttpClientPool &) = delete;
+    ~HttpClientPool();
+    std::shared_ptr<Lease> acquire();  // Reuse an idle client or create one, waits while the pool is exhausted
+    pplx::task<std::shared_ptr<Lease>> acquire_async(); // Same as above, completes once a client is free without blocking a thread
+    void reap_idle();                  // Close idle clients past the idle timeout
+    void set_timeout(std::chrono::milliseconds); // Timeout of clients created from now on, idle clients are closed if it changed
+    std::chrono::milliseconds get_timeout(); // Timeout of new clients
+    size_t idle_count();               // Number of idle clients
+    size_t open_count();               // Number of clients in use plus idle
+    uint64_t created_count();          // Number of clients created so far
+    uint64_t discarded_count();        // Number of clients dropped after an error
+};
+
+#endif
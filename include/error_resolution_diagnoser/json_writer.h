@@ -0,0 +1,43 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_JSON_WRITER_H
+#define ERROR_RESOLUTION_DIAGNOSER_JSON_WRITER_H
+
+#include <string>
+#include <cstddef>
+
+class JsonWriter
+{
+
+    // This class provides a streaming JSON writer into a reusable buffer for payloads with a fixed schema.
+    // Output is byte compatible with cpprest json::value::serialize, so keys must be written in the sorted
+    // order cpprest objects keep. Keys are string literals and are written without escaping.
+
+    std::string buffer; // Output, keeps its capacity across clear()
+    bool need_comma;    // A member or element was written at the current level
+
+    void separate();    // Comma before the next key if needed
+
+public:
+    JsonWriter();
+    void clear();                            // Empty the buffer to start a new document
+    void begin_object();                     // Write "{"
+    void end_object();                       // Write "}"
+    template <size_t N>
+    void key(const char (&name)[N])          // Write a literal key and the colon
+    {
+        this->separate();
+        this->buffer.push_back('"');
+        this->buffer.append(name, N - 1);
+        this->buffer.append("\":", 2);
+        this->need_comma = false;
+    }
+    void string(const std::string &);        // Write an escaped string value
+    void string(const char *, size_t);       // Write an escaped string value from a buffer
+    void boolean(bool);                      // Write true or false
+    void number(double);                     // Write a double with 17 significant digits like cpprest
+    void null();                             // Write null
+    void raw(const std::string &);           // Write an already serialized value as is
+    const std::string &str() const;          // Document written so far
+    static JsonWriter &local();              // Writer of the calling thread
+};
+
+#endif
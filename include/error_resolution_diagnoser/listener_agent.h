@@ -1,11 +1,26 @@
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 #include <rosgraph_msgs/Log.h>
 #include <nav_msgs/Odometry.h>
 #include <geometry_msgs/PoseWithCovarianceStamped.h>
 #include <diagnostic_msgs/DiagnosticArray.h>
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <error_resolution_diagnoser/state_manager.h>
+#include <error_resolution_diagnoser/spsc_ring.h>
+
+struct PendingLog
+{
+    rosgraph_msgs::Log::ConstPtr rosmsg;              // Queued rosout message
+    Telemetry telemetry;                              // Telemetry at the time the message was taken off the queue
+    pplx::task<web::json::value> classification;      // Classification lookup of the message text
+};
 
 class cs_listener
 {
@@ -13,25 +28,52 @@ class cs_listener
 
     std::string agent_type;                // DB or ROS agent
     std::string robot_code;                // UUID supplied during setup
+    ros::CallbackQueue log_cb_queue;       // Callback queue of the rosout subscriber
+    ros::CallbackQueue odom_cb_queue;      // Callback queue of the Odometry subscriber
+    ros::CallbackQueue pose_cb_queue;      // Callback queue of the Pose subscriber
+    ros::CallbackQueue diag_cb_queue;      // Callback queue of the Diagnostics subscriber
+    ros::CallbackQueue heartbeat_cb_queue; // Callback queue of the heartbeat timer
+    std::vector<std::unique_ptr<ros::AsyncSpinner>> spinners; // One single threaded spinner per callback queue
     ros::WallTimer heartbeat_timer;        // ROS timer that is configured to with heartbeat_start as callback
     ros::WallDuration heartrate;           // Period duration for heartbeat_timer
     StateManager state_manager_instance;   // State manager object that processes all incoming messages
     ros::Subscriber odom_sub;              // Subscriber for Odometry telemetry info
     ros::Subscriber pose_sub;              // Subscriber for Pose telemetry info
     ros::Subscriber diag_sub;              // Subscriber for Diagnostics info
-    web::json::value telemetry;            // JSON value that will be pushed as a part of event/status
+    ros::Subscriber log_sub;               // Subscriber for rosout_agg messages
+    TelemetryStore telemetry;              // Latest poses that will be pushed as a part of event/status
     bool telemetry_ok;                     // Used to check if telemetry subs have been setup
     int num_diag_samples;                  // Down sample factor for diagnostics
     int curr_diag_sample;                  // Keeps track of sample index received
     std::vector<std::string> node_list;    // List of nodes to include messages by
     std::vector<std::string> node_ex_list; // List of nodes to exclude messages by
     std::string diag_setting;              // Keeps track of the diagnostics setting on or off
+    std::unique_ptr<SpscRing<rosgraph_msgs::Log::ConstPtr>> log_queue; // Bounded queue handing rosout messages from log_callback to the log worker
+    std::thread log_worker;                // Thread that runs state management of queued rosout messages
+    std::atomic<bool> log_worker_running;  // Cleared to stop the log worker once the queue is drained
+    std::mutex log_worker_mutex;           // Mutex the idle log worker waits on
+    std::condition_variable log_worker_cv; // Wakes the idle log worker when a message is queued
+    bool log_worker_signaled;              // Set under log_worker_mutex when there is new work for the log worker
+    std::mutex state_mutex;                // Serializes access to state_manager_instance between threads
+    std::deque<PendingLog> pending_logs;   // Messages whose classification is in flight, in arrival order. Only touched by the log worker.
+    size_t max_in_flight;                  // Maximum number of classification lookups in flight
+
+    void log_worker_loop();                                 // Log worker body that drains the queue until stopped
+    void process_log(const rosgraph_msgs::Log::ConstPtr &); // Hands a queued rosout message over to state manager
+    void complete_pending_logs(bool);                       // Hands classified messages over to state manager in arrival order, optionally waiting for the oldest
+    void log_worker_stop();                                 // Stops the log worker after processing every queued message
+    void log_worker_signal();                               // Wakes the log worker for a queued message, a finished lookup or a stop
+    Telemetry get_telemetry();                              // Snapshot of the current telemetry
+    ros::NodeHandle queue_handle(ros::NodeHandle, ros::CallbackQueue *); // Node handle whose subscriptions and timers are serviced by the given queue
 
 public:
     cs_listener();                                                                             // Constructor to set up listener object
     ~cs_listener();                                                                            // Destructor
     void setup_telemetry(ros::NodeHandle);                                                     // Sets up additional subscribers dynamically to populate telemetry
     void setup_diagnostics(ros::NodeHandle);                                                   // Sets up additional diagnostics subscriber
+    void setup_log(ros::NodeHandle);                                                           // Sets up the rosout_agg subscriber
+    void start_spinners();                                                                     // Starts one spinner thread per callback queue
+    void stop_spinners();                                                                      // Stops every spinner thread
     void log_callback(const rosgraph_msgs::Log::ConstPtr &);                                   // Listener callback that hands over the rosout message to state manager for processing
     void odom_callback(const nav_msgs::Odometry::ConstPtr &);                                  // Odometry callback for telemetry info
     void pose_callback(const geometry_msgs::PoseWithCovarianceStamped::ConstPtr &);            // Pose callback for telemetry info
@@ -39,6 +81,14 @@ public:
     void heartbeat_start(ros::NodeHandle);                                                     // Utility method to setup the heartbeat_timer
     void heartbeat_log(const ros::WallTimerEvent &);                                           // Timer callback that logs heartbeat online
     void heartbeat_stop();                                                                     // Method that is called when node is shut down to log heartbeat offline
-    web::json::value odom_to_json(const nav_msgs::Odometry::ConstPtr &);                       // Utility function to convert Odometry message to JSON
-    web::json::value pose_to_json(const geometry_msgs::PoseWithCovarianceStamped::ConstPtr &); // Utility function to convert Pose message to JSON
+    PoseState odom_to_state(const nav_msgs::Odometry::ConstPtr &);                             // Utility function to convert Odometry message to a pose struct
+    PoseState pose_to_state(const geometry_msgs::PoseWithCovarianceStamped::ConstPtr &);       // Utility function to convert Pose message to a pose struct
+    size_t get_log_queue_depth();                                                              // Number of rosout messages waiting for the log worker
+    uint64_t get_log_queue_overflows();                                                        // Number of rosout messages dropped because the queue was full
+    ClassificationStats get_classification_stats();                                            // Hit and miss counters of the classification cache
+    BreakerStats get_ecs_breaker_stats();                                                      // State and counters of the ECS circuit breaker
+    StateUsage get_msg_usage();                                                                // Entries, footprint and evictions of message state
+    StateUsage get_diag_usage();                                                               // Entries, footprint and evictions of diagnostic state
+    StateUsage get_template_usage();                                                           // Templates, footprint and evictions of the template miner
+    bool save_classification_cache();                                                          // Save the classification cache so a crash or kill keeps it
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_LOG_TEMPLATE_MINER_H
+#define ERROR_RESOLUTION_DIAGNOSER_LOG_TEMPLATE_MINER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cctype>
+#include <unordered_map>
+#include <list>
+#include <error_resolution_diagnoser/state_table.h>
+
+class LogTemplateMiner
+{
+
+    // This class provides online log template mining in the style of Drain. Messages are routed through a
+    // fixed-depth parse tree (token count, then leading tokens) to a small group of templates. Tokens carrying
+    // a digit are replaced by a wildcard so numeric variants of the same log line map to one stable template ID.
+    // Words are never generalized, so messages that differ in wording such as "Goal reached" and "Goal aborted"
+    // keep their own templates. Entry and byte limits are enforced by evicting the least recently matched
+    // templates along with the tree branches only they used.
+
+    struct ParseNode
+    {
+        std::unordered_map<std::string, std::unique_ptr<ParseNode>> children; // Child nodes keyed by token
+        std::vector<uint64_t> clusters;                                       // IDs of clusters at a leaf
+        ParseNode *parent;                                                    // Parent node, nullptr in the length layer
+        std::string key;                                                      // Token of this node in its parent
+        size_t length;                                                        // Token count of the branch
+    };
+
+    struct TemplateCluster
+    {
+        uint64_t id;                          // Stable template ID, never changes once assigned
+        std::vector<std::string> tokens;      // Template tokens, variable positions hold the wildcard
+        ParseNode *leaf;                      // Leaf the template is stored at
+        size_t bytes;                         // Footprint accounted for this template
+        std::list<uint64_t>::iterator recent; // Position in the LRU list
+    };
+
+    int depth;                                              // Depth of the parse tree including root, length and leaf layers
+    size_t max_children;                                    // Maximum children per tree node before routing to the wildcard child
+    std::unordered_map<size_t, ParseNode> length_nodes;     // First layer of the tree keyed by token count
+    std::unordered_map<uint64_t, TemplateCluster> clusters; // Templates by ID
+    std::list<uint64_t> lru;                                // Template IDs, least recently matched first
+    uint64_t next_id;                                       // ID of the next new template
+    size_t max_entries;                                     // Maximum number of templates, 0 is unlimited
+    size_t max_bytes;                                       // Maximum footprint in bytes, 0 is unlimited
+    size_t bytes;                                           // Current footprint of templates and tree nodes in bytes
+    uint64_t evictions;                                     // Number of templates evicted so far
+
+    std::vector<std::string> tokenize(const std::string &) const;                  // Split on whitespace and mask tokens with digits
+    ParseNode *descend(const std::vector<std::string> &);                         // Walk or grow the tree down to a leaf
+    void remove(uint64_t);                                                        // Drop a template and prune the branches left empty
+    void evict(uint64_t);                                                         // Evict least recently matched templates other than the given one until within limits
+    bool matches(const TemplateCluster &, const std::vector<std::string> &) const; // Whether a tokenized message belongs to a template
+
+public:
+    static const std::string WILDCARD;                      // Token used for variable positions
+
+    LogTemplateMiner(int = 4, size_t = 100);
+    uint64_t add_message(const std::string &);             // Match or create the template of a message and return its ID
+    std::string get_template(uint64_t) const;               // Template text of an ID, empty if unknown or evicted
+    void set_limits(size_t, size_t);                        // Set maximum templates and bytes, 0 is unlimited. Evicts immediately if over.
+    StateUsage usage() const;                               // Current templates, footprint and eviction count
+    size_t size() const;                                    // Number of templates kept
+    void clear();                                           // Forget every template
+};
+
+#endif
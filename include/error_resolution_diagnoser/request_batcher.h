@@ -0,0 +1,59 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_REQUEST_BATCHER_H
+#define ERROR_RESOLUTION_DIAGNOSER_REQUEST_BATCHER_H
+
+#include <cpprest/json.h>
+#undef U
+#include <pplx/pplxtasks.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+class RequestBatcher
+{
+
+    // This class provides micro-batching of lookups. Texts submitted close together are sent in one request once the
+    // batch is full or the oldest text has waited the linger time. The request resolves to one result per text in the
+    // same order, and each result is handed back to the task of the text it belongs to. A failed request fails every
+    // text of its batch.
+
+public:
+    typedef std::function<pplx::task<std::vector<web::json::value>>(const std::vector<std::string> &)> SendFunction;
+
+private:
+    struct PendingText
+    {
+        std::string text;                                        // Submitted text
+        pplx::task_completion_event<web::json::value> done;      // Completes the task of the submitter
+    };
+
+    size_t max_batch;                                    // Texts that make a batch full
+    std::chrono::milliseconds linger;                    // Longest time a text waits for others to join its batch
+    SendFunction send;                                   // Sends one batch request
+    std::vector<PendingText> pending;                    // Texts waiting for the next batch, oldest first
+    std::chrono::steady_clock::time_point oldest;        // Time the oldest pending text was submitted
+    bool running;                                        // Cleared to flush what is pending and stop
+    uint64_t batches;                                    // Number of batch requests sent
+    uint64_t texts;                                      // Number of texts sent
+    std::mutex batch_mutex;                              // Guards everything above
+    std::condition_variable batch_cv;                    // Wakes the flusher when a text is submitted or on stop
+    std::thread flusher;                                 // Thread that sends batches once full or lingered
+
+    void flush_loop();                                   // Flusher body
+    void dispatch(std::vector<PendingText>);             // Send one batch and hand the results back
+
+public:
+    RequestBatcher(size_t, std::chrono::milliseconds, SendFunction);
+    RequestBatcher(const RequestBatcher &) = delete;
+    RequestBatcher &operator=(const RequestBatcher &) = delete;
+    ~RequestBatcher();                                   // Sends what is pending and stops the flusher
+    pplx::task<web::json::value> submit(const std::string &); // Result of the text once its batch is answered
+    uint64_t batch_count();                              // Number of batch requests sent so far
+    uint64_t text_count();                               // Number of texts sent so far
+};
+
+#endif
@@ -2,26 +2,26 @@
 #undef U
 #include <string>
 #include <vector>
-#include <boost/uuid/uuid.hpp>            // uuid class
-#include <boost/uuid/uuid_generators.hpp> // generators
-#include <boost/uuid/uuid_io.hpp>         // streaming operators etc.
-#include <boost/date_time.hpp>
 #include <rosgraph_msgs/Log.h>
+#include <error_resolution_diagnoser/telemetry.h>
+#include <error_resolution_diagnoser/event_record.h>
+#include <error_resolution_diagnoser/event_id.h>
 
 class RobotEvent
 {
 
     // This class provides access to Robot Event to manage event logs for the Agent.
 
-    int queue_id;                                    // Each message has a queue ID
-    std::vector<std::vector<std::string>> event_log; // Event log stored as a vector of vector of strings
-    std::string event_id_str;                        // UUID that identifies an event
+    int queue_id;                                 // Each message has a queue ID
+    std::vector<EventRecord> event_log;           // Event log stored as typed records
+    std::shared_ptr<const std::string> event_id;  // UUID that identifies an event, shared by its records
+    EventIdFormat id_format;                      // Random or time ordered event IDs
 
 public:
     RobotEvent();
-    void update_log(const rosgraph_msgs::Log::ConstPtr &, web::json::value, web::json::value, std::string); // Append to event log
-    void update_event_id();                                                                                 // Update event id, create and udpate if necessary
-    std::vector<std::vector<std::string>> get_log();                                                        // Return event log
-    void clear_log();                                                                                       // Clear only event log
-    void clear();                                                                                           // Clearing all events
+    void update_log(const rosgraph_msgs::Log::ConstPtr &, web::json::value, const Telemetry &, std::string); // Append to event log
+    void update_event_id();                                                                                  // Update event id, create and udpate if necessary
+    const std::vector<EventRecord> &get_log() const;                                                         // Return event log, valid until the next update or clear
+    void clear_log();                                                                                        // Clear only event log
+    void clear();                                                                                            // Clearing all events
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_RULE_MATCHER_H
+#define ERROR_RESOLUTION_DIAGNOSER_RULE_MATCHER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+enum class RuleKind : uint8_t
+{
+    CONTAINS = 0, // Pattern appears anywhere in the text
+    PREFIX = 1,   // Text starts with the pattern
+    SUFFIX = 2,   // Text ends with the pattern
+    EXACT = 3,    // Text is the pattern
+    GLOB = 4      // Whole text matches the pattern, '*' is any run of bytes and '?' any single byte
+};
+
+class RuleMatcher
+{
+
+    // This class provides a multi-pattern matcher that finds the first rule matching a text in one pass over its
+    // bytes, however many rules there are. Literal rules are compiled into one Aho-Corasick automaton with the
+    // failure links folded into a full transition table. Glob rules run together as one DFA whose states are built
+    // from the rules' NFA on first use and cached. Matches walk the cached states without locking, only building a new
+    // state takes the lock. Bytes that appear in no pattern share one input class, which keeps both tables small.
+    // When several rules match, the one added first wins.
+
+    struct Rule
+    {
+        std::string pattern; // Bytes to match
+        RuleKind kind;       // How the pattern must match
+    };
+
+    struct GlobState
+    {
+        int32_t accept;                               // First glob rule the state accepts, -1 if none
+        std::unique_ptr<std::atomic<int32_t>[]> next; // Transition per input class, -1 until built
+    };
+
+    struct GlobDfa
+    {
+        std::vector<std::unique_ptr<GlobState>> states; // Sized to MAX_GLOB_STATES up front so it never moves, 0 is the dead state and 1 the start
+        std::vector<std::vector<uint32_t>> sets;        // NFA states of each DFA state, only used under dfa_mutex
+        std::map<std::vector<uint32_t>, int32_t> index; // DFA state of each NFA state set, only used under dfa_mutex
+    };
+
+    static const size_t MAX_GLOB_STATES = 4096; // Cached glob DFA states before the cache is started over
+
+    std::vector<Rule> rules;                     // Rules in the order they were added
+    uint16_t byte_class[256];                    // Input class of every byte, up to 256 classes plus the one of unused bytes
+    size_t num_classes;                          // Number of input classes
+    bool compiled;                               // Whether the automata match the rules
+
+    std::vector<int32_t> ac_next;                // Aho-Corasick transitions, node * num_classes + class
+    std::vector<std::vector<uint32_t>> ac_out;   // Literal rules ending at each node
+    std::vector<int32_t> ac_dict;                // Closest node on the failure chain with rules ending there, -1 if none
+    std::vector<uint32_t> empty_rules;           // Literal rules with an empty pattern
+
+    std::vector<uint32_t> glob_rules;            // Glob rules
+    std::vector<uint32_t> glob_offset;           // First NFA state of each glob rule, one past the end for the last
+    std::shared_ptr<GlobDfa> glob_dfa;           // Glob DFA cache, replaced whole when full so matches in progress keep theirs
+    std::mutex dfa_mutex;                        // Serializes building glob DFA states
+
+    void compile_literals();                                // Build the Aho-Corasick automaton
+    void compile_globs();                                   // Number the glob NFA states and start the glob DFA cache
+    std::shared_ptr<GlobDfa> new_glob_dfa() const;          // Empty glob DFA cache with its dead and start states
+    void glob_closure(std::vector<uint32_t> &) const;       // Add the states reachable by skipping '*'
+    int32_t glob_state(GlobDfa &, std::vector<uint32_t> &) const; // DFA state of an NFA state set, built if new. Needs dfa_mutex.
+    int32_t glob_step(std::shared_ptr<GlobDfa> &, int32_t, uint16_t); // DFA transition, built if new. May move the walk to a new cache.
+    bool literal_applies(uint32_t, size_t, size_t) const;   // Whether a literal match ending at a position satisfies its rule
+
+public:
+    RuleMatcher();
+    RuleMatcher(const RuleMatcher &) = delete;
+    RuleMatcher &operator=(const RuleMatcher &) = delete;
+    uint32_t add_rule(const std::string &, RuleKind);      // Add a rule, returns its id. Ids count up from 0.
+    void compile();                                         // Build the automata, must run after the last add_rule and before any match
+    int32_t match(const std::string &);                     // Id of the first rule matching the text, -1 if none
+    size_t size() const;                                    // Number of rules
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_SEQLOCK_H
+#define ERROR_RESOLUTION_DIAGNOSER_SEQLOCK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+template <typename T>
+class Seqlock
+{
+
+    // This class provides a sequence lock around a trivially copyable value for a single writer thread.
+    // The writer never blocks or allocates. Readers retry until they copy a snapshot no write overlapped with.
+    // The value is kept as relaxed atomic words so concurrent copies are free of data races.
+
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock needs a trivially copyable type");
+
+    static const size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t); // Number of words holding the value
+
+    std::atomic<uint32_t> sequence;        // Odd while a write is in progress, advances by two per write
+    std::atomic<uint64_t> words[WORDS];    // Value split into words
+
+public:
+    Seqlock();
+    Seqlock(const Seqlock &) = delete;
+    Seqlock &operator=(const Seqlock &) = delete;
+    void store(const T &);  // Writer side, must only be called from one thread at a time
+    T load() const;         // Reader side, returns a consistent snapshot
+    T load(uint32_t &) const; // Reader side, returns a consistent snapshot and the version it was taken at
+    uint32_t version() const; // Number of completed writes
+};
+
+template <typename T>
+Seqlock<T>::Seqlock()
+{
+    // Start from a value initialized T
+    uint64_t buffer[WORDS] = {};
+    T value = T();
+    memcpy(buffer, &value, sizeof(T));
+
+    for (size_t idx = 0; idx < WORDS; idx++)
+    {
+        this->words[idx].store(buffer[idx], std::memory_order_relaxed);
+    }
+    this->sequence.store(0, std::memory_order_release);
+}
+
+template <typename T>
+void Seqlock<T>::store(const T &value)
+{
+    uint64_t buffer[WORDS] = {};
+    memcpy(buffer, &value, sizeof(T));
+
+    // Mark the write as in progress before touching any word
+    uint32_t seq = this->sequence.load(std::memory_order_relaxed);
+    this->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t idx = 0; idx < WORDS; idx++)
+    {
+        this->words[idx].store(buffer[idx], std::memory_order_relaxed);
+    }
+
+    // Publish the write
+    this->sequence.store(seq + 2, std::memory_order_release);
+}
+
+template <typename T>
+T Seqlock<T>::load() const
+{
+    uint32_t version;
+    return this->load(version);
+}
+
+template <typename T>
+T Seqlock<T>::load(uint32_t &version) const
+{
+    uint64_t buffer[WORDS];
+    uint32_t before;
+    uint32_t after;
+
+    do
+    {
+        before = this->sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            // Writer is mid-way, let it finish
+            std::this_thread::yield();
+            after = before + 1;
+            continue;
+        }
+
+        for (size_t idx = 0; idx < WORDS; idx++)
+        {
+            buffer[idx] = this->words[idx].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = this->sequence.load(std::memory_order_relaxed);
+    } while (before != after);
+
+    T value;
+    memcpy(&value, buffer, sizeof(T));
+    version = before / 2;
+    return value;
+}
+
+template <typename T>
+uint32_t Seqlock<T>::version() const
+{
+    return this->sequence.load(std::memory_order_acquire) / 2;
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_SINGLE_FLIGHT_H
+#define ERROR_RESOLUTION_DIAGNOSER_SINGLE_FLIGHT_H
+
+#include <pplx/pplxtasks.h>
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <unordered_map>
+
+template <typename T>
+class SingleFlight
+{
+
+    // This class lets concurrent calls for the same key share one outstanding task instead of each starting its own.
+    // The first caller starts the work, later callers get the same task until it completes. A key is forgotten as soon
+    // as its task completes, so results are never reused afterwards. Keeping results around is left to a cache.
+
+    std::unordered_map<std::string, pplx::task<T>> in_flight; // Shared task of every key with work outstanding
+    uint64_t started;                                         // Number of calls that started work
+    uint64_t coalesced;                                       // Number of calls that joined work already outstanding
+    std::mutex flight_mutex;                                  // Guards everything above
+
+    void forget(const std::string &); // Drop a key whose work completed
+
+public:
+    SingleFlight();
+    SingleFlight(const SingleFlight &) = delete;
+    SingleFlight &operator=(const SingleFlight &) = delete;
+    pplx::task<T> run(const std::string &, const std::function<pplx::task<T>()> &); // Task of the outstanding work for the key, started with the function if there is none
+    size_t in_flight_count();  // Number of keys with work outstanding
+    uint64_t started_count();  // Number of calls that started work so far
+    uint64_t coalesced_count(); // Number of calls that joined work already outstanding so far
+};
+
+template <typename T>
+SingleFlight<T>::SingleFlight()
+{
+    this->started = 0;
+    this->coalesced = 0;
+}
+
+template <typename T>
+pplx::task<T> SingleFlight<T>::run(const std::string &key, const std::function<pplx::task<T>()> &start)
+{
+    pplx::task_completion_event<T> done;
+    pplx::task<T> shared;
+    {
+        std::lock_guard<std::mutex> lock(this->flight_mutex);
+
+        auto found = this->in_flight.find(key);
+        if (found != this->in_flight.end())
+        {
+            this->coalesced++;
+            return found->second;
+        }
+
+        // Waiters get a task of their own completion event, so the work itself is started outside the lock
+        this->started++;
+        shared = pplx::create_task(done);
+        this->in_flight[key] = shared;
+    }
+
+    pplx::task<T> work;
+    try
+    {
+        work = start();
+    }
+    catch (...)
+    {
+        this->forget(key);
+        done.set_exception(std::current_exception());
+        return shared;
+    }
+
+    // Forget the key before waking the waiters, so a call made from a continuation starts fresh work
+    work.then([this, key, done](pplx::task<T> result) {
+        this->forget(key);
+        try
+        {
+            done.set(result.get());
+        }
+        catch (...)
+        {
+            done.set_exception(std::current_exception());
+        }
+    });
+
+    return shared;
+}
+
+template <typename T>
+void SingleFlight<T>::forget(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock(this->flight_mutex);
+    this->in_flight.erase(key);
+}
+
+template <typename T>
+size_t SingleFlight<T>::in_flight_count()
+{
+    std::lock_guard<std::mutex> lock(this->flight_mutex);
+    return this->in_flight.size();
+}
+
+template <typename T>
+uint64_t SingleFlight<T>::started_count()
+{
+    std::lock_guard<std::mutex> lock(this->flight_mutex);
+    return this->started;
+}
+
+template <typename T>
+uint64_t SingleFlight<T>::coalesced_count()
+{
+    std::lock_guard<std::mutex> lock(this->flight_mutex);
+    return this->coalesced;
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_SPSC_RING_H
+#define ERROR_RESOLUTION_DIAGNOSER_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class SpscRing
+{
+
+    // This class provides a bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+    // Push and pop are constant time and never block. Items pushed while the ring is full are dropped and counted.
+
+    std::vector<T> buffer;                 // Slots of the ring, size is a power of two
+    size_t mask;                           // Mask to get a slot index from a position
+    alignas(64) std::atomic<size_t> head;  // Position of the next item to pop, written by the consumer only
+    alignas(64) std::atomic<size_t> tail;  // Position of the next slot to push, written by the producer only
+    alignas(64) std::atomic<uint64_t> overflows; // Number of items dropped because the ring was full
+
+public:
+    explicit SpscRing(size_t);
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+    bool push(const T &);          // Producer side. Returns false and counts an overflow if full.
+    bool pop(T &);                 // Consumer side. Returns false if empty.
+    size_t depth() const;          // Number of items waiting, may be stale by the time it is read
+    size_t capacity() const;       // Maximum number of items held
+    uint64_t overflow_count() const; // Number of items dropped so far
+};
+
+template <typename T>
+SpscRing<T>::SpscRing(size_t capacity)
+{
+    // Round up to a power of two so positions wrap with a mask
+    size_t slots = 1;
+    while (slots < capacity)
+    {
+        slots <<= 1;
+    }
+
+    this->buffer.resize(slots);
+    this->mask = slots - 1;
+    this->head.store(0, std::memory_order_relaxed);
+    this->tail.store(0, std::memory_order_relaxed);
+    this->overflows.store(0, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool SpscRing<T>::push(const T &item)
+{
+    size_t tail = this->tail.load(std::memory_order_relaxed);
+
+    // Full when the producer is a whole ring ahead of the consumer
+    if (tail - this->head.load(std::memory_order_acquire) > this->mask)
+    {
+        this->overflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Publish the slot only after it is written
+    this->buffer[tail & this->mask] = item;
+    this->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool SpscRing<T>::pop(T &item)
+{
+    size_t head = this->head.load(std::memory_order_relaxed);
+
+    if (head == this->tail.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    // Move the item out and reset the slot so it does not keep resources alive, then release the slot
+    T &slot = this->buffer[head & this->mask];
+    item = std::move(slot);
+    slot = T();
+    this->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+size_t SpscRing<T>::depth() const
+{
+    size_t head = this->head.load(std::memory_order_acquire);
+    size_t tail = this->tail.load(std::memory_order_acquire);
+    return (tail >= head) ? (tail - head) : 0;
+}
+
+template <typename T>
+size_t SpscRing<T>::capacity() const
+{
+    return this->mask + 1;
+}
+
+template <typename T>
+uint64_t SpscRing<T>::overflow_count() const
+{
+    return this->overflows.load(std::memory_order_relaxed);
+}
+
+#endif
@@ -5,10 +5,39 @@
 #include <iostream>
 #include <sstream>
 #include <ctime>
+#include <cmath>
+#include <cstdio>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <rosgraph_msgs/Log.h>
 #include <diagnostic_msgs/DiagnosticArray.h>
 #include <error_resolution_diagnoser/backend_api.h>
 #include <error_resolution_diagnoser/robot_event.h>
+#include <error_resolution_diagnoser/state_table.h>
+#include <error_resolution_diagnoser/log_template_miner.h>
+#include <error_resolution_diagnoser/classification_rules.h>
+#include <error_resolution_diagnoser/telemetry.h>
+#include <error_resolution_diagnoser/timestamp.h>
+
+struct MessageState
+{
+    time_t timestamp; // Time at which the message was first recorded
+};
+
+enum class DiagLevel : uint8_t
+{
+    OK = 0,
+    WARN = 1,
+    ERROR = 2,
+    STALE = 3
+};
+
+struct DiagnosticState
+{
+    DiagLevel level;  // Last reported level of the diagnostic
+    time_t timestamp; // Time at which the diagnostic last changed level
+};
 
 class StateManager
 {
@@ -17,28 +46,54 @@ class StateManager
 
     bool suppress_flag;                             // Boolean flag to decide whether to suppress a message or not
     float alert_timeout_limit;                      // Timeout parameter in minutes for alert timeout
-    std::vector<std::vector<std::string>> msg_data; // Accumulated message for current event stored as vector of vector of strings
+    float error_timeout_limit;                      // Timeout in minutes after which a suppressed error is reported again
+    float warning_timeout_limit;                    // Timeout in minutes after which a suppressed warning is reported again
+    float info_timeout_limit;                       // Timeout in minutes after which a suppressed info is reported again
+    StateTable<MessageState> msg_data;              // Accumulated messages for current event indexed by (robot_code, message)
     BackendApi api_instance;                        // Back end API instance
     RobotEvent event_instance;                      // Robot event instance
-    std::vector<std::vector<std::string>> diag_data;// Accumulated diagnostics stored as vector of vector of strings
+    StateTable<DiagnosticState> diag_data;          // Last known level of each diagnostic indexed by (robot_code, name_hardware_id)
+    std::string dedup_mode;                         // Key used to suppress ROS messages, TEXT for the raw message, TEMPLATE for its mined template or CALLSITE for its call site fingerprint
+    LogTemplateMiner template_miner;                // Online template miner used in TEMPLATE dedup mode
+    std::mutex template_mutex;                      // Guards the template miner, which lookups use without holding the state
+    std::unique_ptr<ClassificationRules> rules;     // Local classification rules used in RULES mode, null in other modes
+
+    void check_suppression(const std::string &, const std::string &, float); // Common suppression check with expiry after the given timeout in minutes
+    std::string suppression_key(const rosgraph_msgs::Log::ConstPtr &);       // Key a message is suppressed on according to the dedup mode
 
 public:
     StateManager();
     // ~StateManager();
     std::vector<std::string> does_exist(std::string, std::string);                                        // Check if message already logged with this robot
-    void check_message(std::string, std::string, const rosgraph_msgs::Log::ConstPtr &, web::json::value); // Entry point to state management that calls the correct variant of check_message*
-    void check_message_ecs(std::string, const rosgraph_msgs::Log::ConstPtr &, web::json::value);          // State management in case of ECS feedback
-    void check_message_ert(std::string, const rosgraph_msgs::Log::ConstPtr &, web::json::value);          // State management in case of ERT feedback
-    void check_message_ros(std::string, const rosgraph_msgs::Log::ConstPtr &, web::json::value);          // State management in case of a ROS direct feed
+    void check_message(std::string, std::string, const rosgraph_msgs::Log::ConstPtr &, const Telemetry &); // Entry point to state management that calls the correct variant of check_message*
+    void check_message(std::string, std::string, const rosgraph_msgs::Log::ConstPtr &, const Telemetry &, const web::json::value &); // Same as above with the classification already looked up
+    pplx::task<web::json::value> classify_message(const std::string &);                                  // Start the classification lookup of a message text, resolves to null if there is none
+    void check_message_ecs(std::string, const rosgraph_msgs::Log::ConstPtr &, const Telemetry &);         // State management in case of ECS feedback
+    void check_message_ecs(std::string, const rosgraph_msgs::Log::ConstPtr &, const Telemetry &, const web::json::value &); // State management in case of ECS feedback already looked up
+    void check_message_ert(std::string, const rosgraph_msgs::Log::ConstPtr &, const Telemetry &);         // State management in case of ERT feedback
+    void check_message_ert(std::string, const rosgraph_msgs::Log::ConstPtr &, const Telemetry &, const web::json::value &); // State management in case of ERT feedback already looked up
+    void check_message_rules(std::string, const rosgraph_msgs::Log::ConstPtr &, const Telemetry &);       // State management in case of local classification rules
+    void check_message_ros(std::string, const rosgraph_msgs::Log::ConstPtr &, const Telemetry &);         // State management in case of a ROS direct feed
     void check_error(std::string, std::string);                                                           // Check error suppression
     void check_warning(std::string, std::string);                                                         // Check warning suppression
     void check_info(std::string, std::string);                                                            // Check info suppression
-    void check_heartbeat(bool, web::json::value);                                                         // Performs heartbeat check and pushes appropriate data
-    void check_diagnostic(std::string, std::string, std::vector<diagnostic_msgs::DiagnosticStatus>, web::json::value); // Entry point to state management that calls the correct variant of check_diagnostic*
-    void check_diagnostic_ecs(std::string, std::vector<diagnostic_msgs::DiagnosticStatus>, web::json::value);  //// State management for diagnostics in case of ECS feedback
-    void check_diagnostic_ert(std::string, std::vector<diagnostic_msgs::DiagnosticStatus>, web::json::value);  //// State management for diagnostics in case of ECS feedback
-    void check_diagnostic_ros(std::string, std::vector<diagnostic_msgs::DiagnosticStatus>, web::json::value);  //// State management for diagnostics in case of ROS direct feed
+    void check_heartbeat(bool, const Telemetry &);                                                        // Performs heartbeat check and pushes appropriate data
+    void check_diagnostic(std::string, std::string, const std::vector<diagnostic_msgs::DiagnosticStatus> &, const Telemetry &); // Entry point to state management that calls the correct variant of check_diagnostic*
+    void check_diagnostic_ecs(std::string, const std::vector<diagnostic_msgs::DiagnosticStatus> &, const Telemetry &);  //// State management for diagnostics in case of ECS feedback
+    void check_diagnostic_ert(std::string, const std::vector<diagnostic_msgs::DiagnosticStatus> &, const Telemetry &);  //// State management for diagnostics in case of ECS feedback
+    void check_diagnostic_ros(std::string, const std::vector<diagnostic_msgs::DiagnosticStatus> &, const Telemetry &);  //// State management for diagnostics in case of ROS direct feed
     void check_diag_data(std::string, std::string, std::string);                                          // Check diagnostic suppression
+    void check_diag_data(const std::string &, const std::string &, DiagLevel);                            // Check diagnostic suppression and record level transitions in place
     std::vector<std::string> does_diag_exist(std::string, std::string, std::string);                      // Check if message already logged with this robot
+    void set_state_limits(size_t, size_t);                                                                // Set maximum entries and bytes of each state table, 0 is unlimited
+    StateUsage get_msg_usage();                                                                           // Entries, footprint and evictions of message state
+    StateUsage get_diag_usage();                                                                          // Entries, footprint and evictions of diagnostic state
+    ClassificationStats get_classification_stats();                                                       // Hit and miss counters of the classification cache
+    bool save_classification_cache();                                                                     // Save the classification cache for the next run
+    BreakerStats get_ecs_breaker_stats();                                                                 // State and counters of the ECS circuit breaker
+    size_t get_rule_count();                                                                              // Number of local classification rules compiled
+    std::string get_agent_type();                                                                         // Mode the back end API resolved its configuration to
+    size_t get_template_count();                                                                          // Number of message templates kept
+    StateUsage get_template_usage();                                                                      // Templates, footprint and evictions of the template miner
     void clear();                                                                                         // Clearing all states
 };
\ No newline at end of file
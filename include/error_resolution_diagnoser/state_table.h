@@ -0,0 +1,318 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_STATE_TABLE_H
+#define ERROR_RESOLUTION_DIAGNOSER_STATE_TABLE_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <error_resolution_diagnoser/timing_wheel.h>
+
+inline uint64_t hash_state_key(const std::string &robot_code, const std::string &text)
+{
+    // FNV-1a over robot code and text, with a separator step so that ("ab", "c") and ("a", "bc") differ
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (unsigned char c : robot_code)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    hash *= 1099511628211ULL;
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+struct LruNode
+{
+    // Intrusive node of the least-recently-used list
+
+    LruNode *prev; // Towards the most recently used entry
+    LruNode *next; // Towards the least recently used entry
+
+    LruNode() : prev(nullptr), next(nullptr) {}
+};
+
+struct StateUsage
+{
+    size_t entries;     // Number of stored entries
+    size_t bytes;       // Approximate heap footprint of the stored entries
+    uint64_t evictions; // Number of entries evicted to stay within the limits
+};
+
+template <typename T>
+class StateTable
+{
+
+    // This class provides a hash-indexed store of state keyed on (robot_code, text) with O(1) average lookup and insert.
+    // Entries can optionally expire, driven by a timing wheel so expiry never rescans the table.
+    // Entry and byte limits are enforced by evicting the least recently used entries.
+
+    struct Entry : TimerNode, LruNode
+    {
+        uint64_t hash;          // Cached hash_state_key of this entry
+        size_t bytes;           // Footprint accounted for this entry
+        std::string robot_code; // Robot code the state belongs to
+        std::string text;       // Message text or diagnostic identity the state is keyed on
+        T value;                // Stored state
+
+        Entry(uint64_t hash, const std::string &robot_code, const std::string &text, const T &value)
+            : hash(hash), bytes(0), robot_code(robot_code), text(text), value(value) {}
+    };
+
+    typedef typename std::unordered_multimap<uint64_t, Entry>::iterator EntryIterator;
+
+    std::unordered_multimap<uint64_t, Entry> entries; // Entries indexed by hash_state_key, colliding keys share a bucket
+    TimingWheel expiry_wheel;                         // Expiry schedule of entries that have a timeout
+    std::vector<TimerNode *> expired;                 // Scratch buffer reused for expired nodes
+    LruNode lru;                                      // Sentinel of the LRU list, next is the least recently used entry
+    size_t max_entries;                               // Maximum number of entries, 0 is unlimited
+    size_t max_bytes;                                 // Maximum footprint in bytes, 0 is unlimited
+    size_t bytes;                                     // Current footprint in bytes
+    uint64_t evictions;                               // Number of entries evicted so far
+
+    EntryIterator locate(uint64_t, const std::string &, const std::string &); // Find the map position of a key
+    EntryIterator position(Entry *);                                        // Find the map position of an entry
+    void remove(EntryIterator);                                             // Remove an entry from the map, wheel and LRU list
+    void touch(Entry *);                                                    // Mark an entry as most recently used
+    void evict(const Entry *);                                              // Evict least recently used entries until within limits
+
+public:
+    StateTable();
+    StateTable(const StateTable &) = delete;
+    StateTable &operator=(const StateTable &) = delete;
+    T *find(const std::string &, const std::string &);                 // Return stored state for the key or nullptr if absent
+    T &insert(const std::string &, const std::string &, const T &, uint64_t = 0); // Insert or overwrite state for the key, expiring at an absolute tick (0 never expires)
+    bool erase(const std::string &, const std::string &);              // Remove state for the key, returns true if it existed
+    size_t expire(uint64_t);                                           // Advance to an absolute tick and drop every entry that expired, returns the count
+    void set_limits(size_t, size_t);                                   // Set maximum entries and bytes, 0 is unlimited. Evicts immediately if over.
+    StateUsage usage() const;                                          // Current entries, footprint and eviction count
+    size_t size() const;                                               // Number of stored entries
+    void clear();                                                      // Remove all entries
+};
+
+template <typename T>
+StateTable<T>::StateTable()
+{
+    // Empty circular LRU list and no limits
+    this->lru.prev = &(this->lru);
+    this->lru.next = &(this->lru);
+    this->max_entries = 0;
+    this->max_bytes = 0;
+    this->bytes = 0;
+    this->evictions = 0;
+}
+
+template <typename T>
+typename StateTable<T>::EntryIterator StateTable<T>::locate(uint64_t hash, const std::string &robot_code, const std::string &text)
+{
+    // Walk the (almost always single element) range for this hash and compare the full key
+    auto range = this->entries.equal_range(hash);
+
+    for (auto it = range.first; it != range.second; it++)
+    {
+        if ((it->second.text == text) && (it->second.robot_code == robot_code))
+        {
+            return it;
+        }
+    }
+
+    return this->entries.end();
+}
+
+template <typename T>
+typename StateTable<T>::EntryIterator StateTable<T>::position(Entry *entry)
+{
+    // Entries are found again through their cached hash
+    auto range = this->entries.equal_range(entry->hash);
+
+    for (auto it = range.first; it != range.second; it++)
+    {
+        if (&(it->second) == entry)
+        {
+            return it;
+        }
+    }
+
+    return this->entries.end();
+}
+
+template <typename T>
+void StateTable<T>::remove(EntryIterator it)
+{
+    Entry *entry = &(it->second);
+
+    // Take the entry off the wheel and the LRU list before freeing it
+    LruNode *node = entry;
+    this->expiry_wheel.cancel(entry);
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    this->bytes -= entry->bytes;
+    this->entries.erase(it);
+}
+
+template <typename T>
+void StateTable<T>::touch(Entry *entry)
+{
+    // Unlink if already on the list, then append as most recently used
+    LruNode *node = entry;
+    if (node->next != nullptr)
+    {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+    }
+    node->next = &(this->lru);
+    node->prev = this->lru.prev;
+    this->lru.prev->next = node;
+    this->lru.prev = node;
+}
+
+template <typename T>
+void StateTable<T>::evict(const Entry *keep)
+{
+    // Evict from the least recently used end, never the entry that is being kept
+    while (((this->max_entries > 0) && (this->entries.size() > this->max_entries)) ||
+           ((this->max_bytes > 0) && (this->bytes > this->max_bytes)))
+    {
+        Entry *victim = static_cast<Entry *>(this->lru.next);
+        if ((this->lru.next == &(this->lru)) || (victim == keep))
+        {
+            break;
+        }
+
+        this->remove(this->position(victim));
+        this->evictions++;
+    }
+}
+
+template <typename T>
+T *StateTable<T>::find(const std::string &robot_code, const std::string &text)
+{
+    auto it = this->locate(hash_state_key(robot_code, text), robot_code, text);
+
+    if (it == this->entries.end())
+    {
+        return nullptr;
+    }
+
+    this->touch(&(it->second));
+    return &(it->second.value);
+}
+
+template <typename T>
+T &StateTable<T>::insert(const std::string &robot_code, const std::string &text, const T &value, uint64_t expiry)
+{
+    uint64_t hash = hash_state_key(robot_code, text);
+    auto it = this->locate(hash, robot_code, text);
+
+    if (it == this->entries.end())
+    {
+        it = this->entries.emplace(std::piecewise_construct, std::forward_as_tuple(hash),
+                                   std::forward_as_tuple(hash, robot_code, text, value));
+
+        // Approximate footprint: map node with bucket pointer plus heap allocated key strings
+        Entry &entry = it->second;
+        entry.bytes = sizeof(std::pair<const uint64_t, Entry>) + 2 * sizeof(void *);
+        if (entry.robot_code.capacity() >= sizeof(std::string))
+        {
+            entry.bytes += entry.robot_code.capacity() + 1;
+        }
+        if (entry.text.capacity() >= sizeof(std::string))
+        {
+            entry.bytes += entry.text.capacity() + 1;
+        }
+        this->bytes += entry.bytes;
+    }
+    else
+    {
+        it->second.value = value;
+    }
+
+    // Entries live in unordered_multimap nodes, so their address is stable and can sit on the wheel
+    if (expiry == 0)
+    {
+        this->expiry_wheel.cancel(&(it->second));
+    }
+    else
+    {
+        this->expiry_wheel.schedule(&(it->second), expiry);
+    }
+
+    // Most recently used, then make room if over the limits
+    this->touch(&(it->second));
+    this->evict(&(it->second));
+
+    return it->second.value;
+}
+
+template <typename T>
+bool StateTable<T>::erase(const std::string &robot_code, const std::string &text)
+{
+    auto it = this->locate(hash_state_key(robot_code, text), robot_code, text);
+
+    if (it == this->entries.end())
+    {
+        return false;
+    }
+
+    this->remove(it);
+    return true;
+}
+
+template <typename T>
+size_t StateTable<T>::expire(uint64_t now)
+{
+    // Only the wheel slots that are due are touched
+    this->expired.clear();
+    this->expiry_wheel.advance(now, this->expired);
+
+    for (TimerNode *node : this->expired)
+    {
+        this->remove(this->position(static_cast<Entry *>(node)));
+    }
+
+    return this->expired.size();
+}
+
+template <typename T>
+void StateTable<T>::set_limits(size_t max_entries, size_t max_bytes)
+{
+    this->max_entries = max_entries;
+    this->max_bytes = max_bytes;
+    this->evict(nullptr);
+}
+
+template <typename T>
+StateUsage StateTable<T>::usage() const
+{
+    StateUsage current;
+    current.entries = this->entries.size();
+    current.bytes = this->bytes;
+    current.evictions = this->evictions;
+    return current;
+}
+
+template <typename T>
+size_t StateTable<T>::size() const
+{
+    return this->entries.size();
+}
+
+template <typename T>
+void StateTable<T>::clear()
+{
+    this->expiry_wheel.clear();
+    this->entries.clear();
+    this->lru.prev = &(this->lru);
+    this->lru.next = &(this->lru);
+    this->bytes = 0;
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_TELEMETRY_H
+#define ERROR_RESOLUTION_DIAGNOSER_TELEMETRY_H
+
+#include <cpprest/json.h>
+#undef U
+#include <string>
+#include <mutex>
+#include <memory>
+#include <error_resolution_diagnoser/seqlock.h>
+#include <error_resolution_diagnoser/json_writer.h>
+
+struct PoseState
+{
+    bool valid;           // Set once a pose has been received
+    double position_x;    // Position
+    double position_y;
+    double position_z;
+    double orientation_w; // Orientation quaternion
+    double orientation_x;
+    double orientation_y;
+    double orientation_z;
+};
+
+struct TelemetrySnapshot
+{
+    PoseState odom_pose; // Last pose from odometry
+    PoseState nav_pose;    // Last pose from localization
+    uint32_t odom_version; // Number of odometry pose changes the snapshot includes
+    uint32_t nav_version;  // Number of localization pose changes the snapshot includes
+};
+
+web::json::value snapshot_to_json(const TelemetrySnapshot &); // JSON of the received poses of a snapshot
+void write_snapshot(JsonWriter &, const TelemetrySnapshot &); // Stream the same JSON as snapshot_to_json into a writer
+
+class TelemetryStore
+{
+
+    // This class provides the latest telemetry as plain pose structs. Each pose has its own writer thread and seqlock,
+    // so writers never allocate or block and readers take consistent snapshots without locking.
+    // Each pose is versioned by change, and the serialized telemetry of the latest pair of versions is cached for reuse.
+
+    Seqlock<PoseState> odom_pose;      // Written by the odometry callback only
+    Seqlock<PoseState> nav_pose;       // Written by the pose callback only
+    mutable std::mutex cache_mutex;    // Guards the serialization cache
+    mutable bool cache_valid;          // Set once the cache holds a serialization
+    mutable uint32_t cached_odom_version; // Odometry version the cached serialization belongs to
+    mutable uint32_t cached_nav_version;  // Localization version the cached serialization belongs to
+    mutable std::shared_ptr<const std::string> cached_str; // Serialized telemetry of the cached versions
+
+public:
+    TelemetryStore();
+    void set_odom_pose(const PoseState &);               // Record the latest odometry pose, ignored if unchanged
+    void set_nav_pose(const PoseState &);                // Record the latest localization pose, ignored if unchanged
+    TelemetrySnapshot snapshot() const;                  // Consistent copy of every pose
+    std::shared_ptr<const std::string> serialize(const TelemetrySnapshot &) const; // Serialized snapshot, shared while neither version changes
+};
+
+class Telemetry
+{
+
+    // This class provides the telemetry attached to an event or heartbeat. It holds either a pose snapshot
+    // or a ready JSON value, and only builds JSON when an event is actually emitted.
+
+    bool from_snapshot;          // True if built from a pose snapshot
+    TelemetrySnapshot snapshot;  // Pose snapshot
+    const TelemetryStore *store; // Store the snapshot was taken from, serves cached serializations
+    web::json::value value;      // Ready JSON value
+
+public:
+    Telemetry();                            // Empty telemetry
+    Telemetry(const web::json::value &);    // Telemetry from a ready JSON value
+    Telemetry(const TelemetrySnapshot &, const TelemetryStore * = nullptr); // Telemetry from a pose snapshot
+    web::json::value to_json() const;       // JSON of the telemetry
+    std::shared_ptr<const std::string> serialized() const; // Serialized telemetry, shared by the store across events
+};
+
+#endif
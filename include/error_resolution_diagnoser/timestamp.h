@@ -0,0 +1,47 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_TIMESTAMP_H
+#define ERROR_RESOLUTION_DIAGNOSER_TIMESTAMP_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+struct Timestamp
+{
+    int64_t sec;   // Seconds since the Unix epoch, UTC
+    uint32_t usec; // Microseconds within the second
+
+    static Timestamp now();                          // Current wall time
+    static Timestamp from_stamp(uint32_t, uint32_t); // From seconds and nanoseconds of a ROS time
+
+    template <typename StampT>
+    static Timestamp from_stamp(const StampT &stamp) // From a ROS message header.stamp
+    {
+        return from_stamp(stamp.sec, stamp.nsec);
+    }
+};
+
+class TimestampFormatter
+{
+
+    // This class provides ISO 8601 formatting of UTC timestamps into caller provided buffers. The date and time
+    // up to the seconds are computed once per second and cached, only the sub-second digits are written for each
+    // call. No locale or C library time functions are used. Use local() to get the formatter of the calling thread.
+
+    int64_t cached_sec;       // Second the cached prefix belongs to
+    char cached_prefix[19];   // "YYYY-MM-DDTHH:MM:SS" of cached_sec
+
+    const char *prefix(int64_t); // Cached prefix, refreshed when the second changes
+
+public:
+    static const size_t ISO_SIZE = 26;         // Longest output of format_iso, "YYYY-MM-DDTHH:MM:SS.ffffff"
+    static const size_t ISO_SECONDS_SIZE = 20; // Output size of format_iso_seconds, "YYYY-MM-DDTHH:MM:SSZ"
+
+    TimestampFormatter();
+    size_t format_iso(const Timestamp &, char *);      // Extended ISO time as boost to_iso_extended_string, fraction left out when zero. Returns length.
+    size_t format_iso_seconds(int64_t, char *);        // Extended ISO time in whole seconds with a Z suffix. Returns length.
+    std::string iso_string(const Timestamp &);         // format_iso as a string
+    static void format_civil(int64_t, char *);         // Uncached "YYYY-MM-DDTHH:MM:SS" of a Unix time
+    static TimestampFormatter &local();                // Formatter of the calling thread
+};
+
+#endif
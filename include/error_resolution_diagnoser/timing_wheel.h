@@ -0,0 +1,52 @@
+#ifndef ERROR_RESOLUTION_DIAGNOSER_TIMING_WHEEL_H
+#define ERROR_RESOLUTION_DIAGNOSER_TIMING_WHEEL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+struct TimerNode
+{
+    // Intrusive list node embedded in anything that can expire. Unlinked nodes have next == nullptr.
+
+    TimerNode *prev;  // Previous node in the wheel slot
+    TimerNode *next;  // Next node in the wheel slot
+    uint64_t expiry;  // Absolute tick at which the node expires
+
+    TimerNode() : prev(nullptr), next(nullptr), expiry(0) {}
+    bool is_scheduled() const { return this->next != nullptr; }
+};
+
+class TimingWheel
+{
+
+    // This class provides a hierarchical timing wheel. Scheduling, cancelling and each tick are O(1),
+    // expired nodes are found without rescanning anything that is not due.
+
+    static const int LEVELS = 4;                      // Number of wheel levels
+    static const int SLOT_BITS = 6;                   // Each level has 2^SLOT_BITS slots
+    static const int SLOTS = 1 << SLOT_BITS;          // Number of slots per level
+    static const uint64_t SLOT_MASK = SLOTS - 1;      // Mask to get a slot index from a tick
+
+    TimerNode slots[LEVELS][SLOTS];                   // Sentinel heads of the circular slot lists
+    TimerNode overflow;                               // Sentinel head of nodes due beyond the range of the top level
+    uint64_t now;                                     // Current tick of the wheel
+    size_t count;                                     // Number of scheduled nodes
+
+    void place(TimerNode *);                          // Link a node into the slot matching its expiry
+    void link(TimerNode *, TimerNode *);              // Link a node at the tail of a slot list
+    void cascade(TimerNode *, std::vector<TimerNode *> &); // Re-place every node of a list, collecting the ones that are due
+
+public:
+    TimingWheel();
+    TimingWheel(const TimingWheel &) = delete;
+    TimingWheel &operator=(const TimingWheel &) = delete;
+    void schedule(TimerNode *, uint64_t);             // Schedule (or reschedule) a node to expire at an absolute tick
+    void cancel(TimerNode *);                         // Remove a node from the wheel if it is scheduled
+    void advance(uint64_t, std::vector<TimerNode *> &); // Advance to an absolute tick and collect every node that expired
+    void clear();                                     // Unlink every node
+    uint64_t current_tick() const;                    // Current tick of the wheel
+    size_t size() const;                              // Number of scheduled nodes
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include <error_resolution_diagnoser/atomic_file.h>
+#include <cerrno>
+#include <cstdio>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+bool write_file_atomic(const std::string &path, const std::string &contents)
+{
+    // Process ID keeps the name readable, mkstemp makes it unique even within a process
+    std::string tmp_name = path + "." + std::to_string(getpid()) + ".XXXXXX";
+    std::vector<char> tmp_path(tmp_name.begin(), tmp_name.end());
+    tmp_path.push_back('\0');
+    int fd = mkstemp(tmp_path.data());
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // mkstemp creates the file private to the owner, the files written here are meant to be read by other agents
+    bool ok = (fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) == 0);
+    size_t written = 0;
+    while (ok && (written < contents.size()))
+    {
+        ssize_t len = write(fd, contents.data() + written, contents.size() - written);
+        if (len < 0)
+        {
+            ok = (errno == EINTR);
+            continue;
+        }
+        written += static_cast<size_t>(len);
+    }
+
+    // Contents must be on disk before the rename makes them visible
+    ok = ok && (fsync(fd) == 0);
+    ok = (close(fd) == 0) && ok;
+    if (!ok || (std::rename(tmp_path.data(), path.c_str()) != 0))
+    {
+        std::remove(tmp_path.data());
+        return false;
+    }
+
+    // Persist the rename itself, best effort
+    std::string::size_type slash = path.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? std::string(".") : ((slash == 0) ? std::string("/") : path.substr(0, slash));
+    int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0)
+    {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+
+    return true;
+}
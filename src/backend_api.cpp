@@ -8,6 +8,54 @@ using namespace concurrency::streams; // Asynchronous streams
 using namespace ::pplx;               // PPLX for tasks
 using namespace web::json;            // JSON features
 
+static size_t limit_from_env(const char *env_name, size_t default_limit)
+{
+  // Positive integer from the environment, or the default if unset or invalid
+  if (std::getenv(env_name))
+  {
+    try
+    {
+      size_t limit = std::stoul(std::getenv(env_name));
+      if (limit > 0)
+      {
+        std::cout << env_name << ": " << limit << std::endl;
+        return limit;
+      }
+    }
+    catch (const std::exception &e)
+    {
+    }
+    std::cerr << env_name << " is set to an invalid value. Defaulting to " << default_limit << "." << std::endl;
+  }
+
+  return default_limit;
+}
+
+static http_response record_response(CircuitBreaker *breaker, std::chrono::steady_clock::time_point start, pplx::task<http_response> &response_task)
+{
+  // Feed the outcome of a request to the breaker of its endpoint. Server errors count as failures.
+  http_response response;
+  try
+  {
+    response = response_task.get();
+  }
+  catch (const http::http_exception &e)
+  {
+    breaker->record_failure();
+    throw;
+  }
+
+  if (response.status_code() >= status_codes::InternalError)
+  {
+    breaker->record_failure();
+  }
+  else
+  {
+    breaker->record_success(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start));
+  }
+  return response;
+}
+
 BackendApi::BackendApi()
 {
 
@@ -67,6 +115,12 @@ BackendApi::BackendApi()
     std::cout << "TEST mode is ON. JSON Logs will be saved here: " << disp_dir << std::endl;
   }
 
+  // Circuit breakers pause requests to an endpoint that keeps failing, timeouts adapt to its response times
+  size_t breaker_failures = limit_from_env("API_BREAKER_FAILURES", 5);
+  size_t breaker_open_sec = limit_from_env("API_BREAKER_OPEN_SEC", 5);
+  size_t timeout_ms = limit_from_env("API_TIMEOUT_MS", 2000);
+  this->post_breaker.reset(new CircuitBreaker("POST API", breaker_failures, std::chrono::seconds(breaker_open_sec), std::chrono::milliseconds(timeout_ms)));
+
   // Error classification API variables
 
   if ((this->agent_type == "ERT") || (this->agent_type == "DB"))
@@ -85,12 +139,79 @@ BackendApi::BackendApi()
     this->ecs_api_endpoint = "";
   }
 
+  if (!(this->ecs_api_endpoint.empty()) && std::getenv("ECS_TABLE_FILE"))
+  {
+    // Offline classification from a table snapshot answers every lookup in place of the API
+    std::string table_file = std::getenv("ECS_TABLE_FILE");
+    this->ecs_index.reset(new ClassificationIndex());
+    size_t rows = this->ecs_index->load(table_file, this->ecs_robot_model);
+    std::cout << "ECS_TABLE_FILE: " << table_file << ", rows loaded: " << rows << std::endl;
+    if ((rows == 0) && !(this->ecs_api_host.empty()))
+    {
+      std::cerr << "Classification table is empty. Falling back to ECS API at: " << this->ecs_api_host << std::endl;
+      this->ecs_index.reset();
+    }
+    else if (rows == 0)
+    {
+      // Nothing could ever be classified, so report messages like ROS mode does
+      std::cerr << "Agent configured in " << this->agent_type << " mode but ECS_TABLE_FILE has no rows and ECS_API is not configured. Defaulting back to ROS mode instead..." << std::endl;
+      this->ecs_index.reset();
+      this->agent_type = "ROS";
+      this->ecs_api_endpoint = "";
+    }
+  }
+
+  if (!(this->ecs_api_endpoint.empty()) && !(this->ecs_api_host.empty()))
+  {
+    // Long-lived clients to the classification host, so lookups reuse warm keep-alive connections
+    http_client_config config;
+    config.set_validate_certificates(false);
+    config.set_timeout(std::chrono::milliseconds(timeout_ms));
+    this->ecs_breaker.reset(new CircuitBreaker("ECS API", breaker_failures, std::chrono::seconds(breaker_open_sec), std::chrono::milliseconds(timeout_ms)));
+    size_t pool_size = limit_from_env("ECS_POOL_SIZE", 4);
+    size_t idle_sec = limit_from_env("ECS_POOL_IDLE_SEC", 60);
+    this->ecs_pool.reset(new HttpClientPool(this->ecs_api_host, config, pool_size, std::chrono::seconds(idle_sec)));
+
+    // Recent answers, including "not in the table", are served without a query
+    size_t cache_size = limit_from_env("ECS_CACHE_SIZE", 4096);
+    size_t hit_ttl_sec = limit_from_env("ECS_CACHE_HIT_TTL_SEC", 3600);
+    size_t miss_ttl_sec = limit_from_env("ECS_CACHE_MISS_TTL_SEC", 300);
+    this->ecs_cache.reset(new ClassificationCache(this->ecs_api_host + this->ecs_api_endpoint + "|" + this->ecs_robot_model, cache_size,
+                                                  std::chrono::seconds(hit_ttl_sec), std::chrono::seconds(miss_ttl_sec)));
+
+    // Warm start from the answers saved by the previous run with the same configuration
+    if (std::getenv("ECS_CACHE_FILE"))
+    {
+      this->ecs_cache_file = std::getenv("ECS_CACHE_FILE");
+    }
+    else
+    {
+      this->ecs_cache_file = std::string(std::getenv("HOME")) + "/.cognicept/agent/ecs_cache.bin";
+    }
+    size_t loaded = this->ecs_cache->load(this->ecs_cache_file);
+    std::cout << "ECS cache entries loaded: " << loaded << std::endl;
+
+    // Lookups arriving close together share one batch request if the API supports it
+    size_t batch_size = limit_from_env("ECS_BATCH_SIZE", 1);
+    size_t batch_linger_ms = limit_from_env("ECS_BATCH_LINGER_MS", 20);
+    if (batch_size > 1)
+    {
+      this->ecs_batcher.reset(new RequestBatcher(batch_size, std::chrono::milliseconds(batch_linger_ms),
+                                                 [this](const std::vector<std::string> &texts) { return this->query_error_classification_batch(texts); }));
+    }
+  }
+
   std::cout << "===========================Diagnosing Started===========================" << std::endl;
 }
 
 BackendApi::~BackendApi()
 {
 
+  // Send lookups still waiting for a batch before the clients go away
+  this->ecs_batcher.reset();
+
+  // Keep the classification answers for the next run
+  this->save_classification_cache();
   // std::cout << "Logged out of API..." << std::endl;
 }
 
@@ -107,11 +228,15 @@ void BackendApi::check_environment()
     // ECS_API, ECS_ROBOT_MODEL
     if ((this->agent_type == "DB") || (this->agent_type == "ERT") || (this->agent_type == "ECS"))
     {
-      if (std::getenv("ECS_API"))
+      // A table snapshot classifies offline, so the API is optional with one
+      if (std::getenv("ECS_API") || std::getenv("ECS_TABLE_FILE"))
       {
         // Success case
-        this->ecs_api_host = std::getenv("ECS_API");
-        std::cout << "ECS_API: " << this->ecs_api_host << std::endl;
+        if (std::getenv("ECS_API"))
+        {
+          this->ecs_api_host = std::getenv("ECS_API");
+          std::cout << "ECS_API: " << this->ecs_api_host << std::endl;
+        }
         if (std::getenv("ECS_ROBOT_MODEL"))
         {
           // Success case
@@ -129,7 +254,7 @@ void BackendApi::check_environment()
       else
       {
         // Failure case - Default
-        std::cerr << "Agent configured in " << this->agent_type << " mode but ECS_API is not configured. Defaulting back to ROS mode instead..." << std::endl;
+        std::cerr << "Agent configured in " << this->agent_type << " mode but neither ECS_API nor ECS_TABLE_FILE is configured. Defaulting back to ROS mode instead..." << std::endl;
         this->agent_type = "ROS";
       }
     }
@@ -270,15 +395,23 @@ void BackendApi::check_environment()
   }
 }
 
-pplx::task<void> BackendApi::post_event_log(json::value payload)
+pplx::task<void> BackendApi::post_event_log(std::string payload)
 {
+  // Skip right away while the endpoint is known to be down
+  if (!(this->post_breaker->allow()))
+  {
+    std::cout << "POST API paused, not posting" << std::endl;
+    return pplx::task_from_result();
+  }
+
   std::cout << "Posting" << std::endl;
 
-  return pplx::create_task([this, payload] {
+  CircuitBreaker *breaker = this->post_breaker.get();
+  return pplx::create_task([this, payload, breaker] {
            // Create HTTP client configuration
            http_client_config config;
            config.set_validate_certificates(false);
-           auto timeout = std::chrono::milliseconds(2000);
+           auto timeout = breaker->timeout();
            config.set_timeout(timeout);
 
            // Create HTTP client
@@ -302,11 +435,14 @@ pplx::task<void> BackendApi::post_event_log(json::value payload)
            {
              req.set_request_uri("/agentstream/put-record");
            }
-           req.set_body(payload);
+           req.set_body(payload, "application/json");
 
            // Request ticket creation
            std::cout << "Pushing downstream..." << std::endl;
-           return client.request(req);
+           std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+           return client.request(req).then([breaker, start](pplx::task<http_response> response_task) {
+             return record_response(breaker, start, response_task);
+           });
          })
       .then([this](http_response response) {
         // If successful, print ticket details
@@ -323,11 +459,11 @@ pplx::task<void> BackendApi::post_event_log(json::value payload)
       });
 }
 
-void BackendApi::push_status(bool status, json::value telemetry)
+void BackendApi::push_status(bool status, const Telemetry &telemetry)
 {
   // Set all required info
-  boost::posix_time::ptime utcTime = boost::posix_time::microsec_clock::universal_time();
-  std::string timestr = to_iso_extended_string(utcTime);
+  char timestr[TimestampFormatter::ISO_SIZE];
+  size_t timelen = TimestampFormatter::local().format_iso(Timestamp::now(), timestr);
   std::string level = "Heartbeat";
   std::string cflag = "Null";
   std::string module = "Status";
@@ -349,47 +485,46 @@ void BackendApi::push_status(bool status, json::value telemetry)
     ticketBool = true;
   }
 
-  // Create JSON object
-  json::value payload = json::value::object();
-
-  // Create keys
-  utility::string_t agentKey(utility::conversions::to_string_t("agent_id"));
-  utility::string_t roboKey(utility::conversions::to_string_t("robot_id"));
-  utility::string_t propKey(utility::conversions::to_string_t("property_id"));
-  utility::string_t eventidKey(utility::conversions::to_string_t("event_id"));
-  utility::string_t timeKey(utility::conversions::to_string_t("timestamp"));
-  utility::string_t msgKey(utility::conversions::to_string_t("message"));
-  utility::string_t lvlKey(utility::conversions::to_string_t("level"));
-  utility::string_t modKey(utility::conversions::to_string_t("module"));
-  utility::string_t srcKey(utility::conversions::to_string_t("source"));
-  utility::string_t cKey(utility::conversions::to_string_t("compounding"));
-  utility::string_t ticketKey(utility::conversions::to_string_t("create_ticket"));
-  utility::string_t descKey(utility::conversions::to_string_t("description"));
-  utility::string_t resKey(utility::conversions::to_string_t("resolution"));
-  utility::string_t telKey(utility::conversions::to_string_t("telemetry"));
-
-  // Assign key-value
-  payload[agentKey] = json::value::string(utility::conversions::to_string_t(this->agent_id));
-  payload[roboKey] = json::value::string(utility::conversions::to_string_t(this->robot_id));
-  payload[propKey] = json::value::string(utility::conversions::to_string_t(this->site_id));
-  payload[eventidKey] = json::value::string(utility::conversions::to_string_t(event_id));
-  payload[timeKey] = json::value::string(utility::conversions::to_string_t(timestr));
-  payload[msgKey] = json::value::string(utility::conversions::to_string_t(message));
-  payload[lvlKey] = json::value::string(utility::conversions::to_string_t(level));
-  payload[modKey] = json::value::string(utility::conversions::to_string_t(module));
-  payload[srcKey] = json::value::string(utility::conversions::to_string_t(source));
-  payload[cKey] = json::value::string(utility::conversions::to_string_t(cflag));
-  payload[ticketKey] = json::value::boolean(ticketBool);
-  payload[descKey] = json::value::string(utility::conversions::to_string_t(description));
-  payload[resKey] = json::value::string(utility::conversions::to_string_t(resolution));
-  payload[telKey] = telemetry;
+  // Telemetry is cached per pose version, fetch it before the payload is written
+  std::shared_ptr<const std::string> telemetry_str = telemetry.serialized();
+
+  // Stream the payload, keys in the sorted order consumers have always received
+  JsonWriter &writer = JsonWriter::local();
+  writer.clear();
+  writer.begin_object();
+  writer.key("agent_id");
+  writer.string(this->agent_id);
+  writer.key("compounding");
+  writer.string(cflag);
+  writer.key("create_ticket");
+  writer.boolean(ticketBool);
+  writer.key("description");
+  writer.string(description);
+  writer.key("event_id");
+  writer.string(event_id);
+  writer.key("level");
+  writer.string(level);
+  writer.key("message");
+  writer.string(message);
+  writer.key("module");
+  writer.string(module);
+  writer.key("property_id");
+  writer.string(this->site_id);
+  writer.key("resolution");
+  writer.string(resolution);
+  writer.key("robot_id");
+  writer.string(this->robot_id);
+  writer.key("source");
+  writer.string(source);
+  writer.key("telemetry");
+  writer.raw(*telemetry_str);
+  writer.key("timestamp");
+  writer.string(timestr, timelen);
+  writer.end_object();
+  const std::string &payload_str = writer.str();
 
   if (this->agent_mode == "JSON_TEST")
   {
-    // Write the current JSON value to a stream with the native platform character width
-    utility::stringstream_t stream;
-    payload.serialize(stream);
-
     // Display the string stream
     // std::cout << stream.str() << std::endl;
     std::cout << "Status Logged: " << message << std::endl;
@@ -399,15 +534,11 @@ void BackendApi::push_status(bool status, json::value telemetry)
     std::string filename = this->log_name + "Status" + this->log_ext;
     // std::cout << filename << std::endl;
     outfile.open(filename);
-    outfile << std::setw(4) << stream.str() << std::endl;
+    outfile << std::setw(4) << payload_str << std::endl;
     outfile.close();
   }
   else if (this->agent_mode == "POST_TEST")
   {
-    // Write the current JSON value to a stream with the native platform character width
-    utility::stringstream_t stream;
-    payload.serialize(stream);
-
     // Display the string stream
     // std::cout << stream.str() << std::endl;
     std::cout << "Status Logged: " << message << std::endl;
@@ -417,13 +548,13 @@ void BackendApi::push_status(bool status, json::value telemetry)
     std::string filename = this->log_name + "Status" + this->log_ext;
     // std::cout << filename << std::endl;
     outfile.open(filename);
-    outfile << std::setw(4) << stream.str() << std::endl;
+    outfile << std::setw(4) << payload_str << std::endl;
     outfile.close();
 
     // Post downstream
     try
     {
-      this->post_event_log(payload).wait();
+      this->post_event_log(payload_str).wait();
     }
     catch (const http::http_exception &e)
     {
@@ -432,86 +563,72 @@ void BackendApi::push_status(bool status, json::value telemetry)
   }
 }
 
-void BackendApi::push_event_log(std::vector<std::vector<std::string>> log)
+void BackendApi::push_event_log(const EventRecord &last_log)
 {
-  // Create JSON payload and push to kinesis
-  auto last_log = log.back();
-  int idx = 0;
+  // Create JSON payload for the latest record and push to kinesis
 
   // Get values for JSON
-  std::string timestr = last_log[idx++];
-  std::string level = last_log[idx++];
-  std::string cflag = last_log[idx++];
-  std::string module = last_log[idx++];
-  std::string source = last_log[idx++];
-  std::string message = last_log[idx++];
-  std::string description = last_log[idx++];
-  std::string resolution = last_log[idx++];
-  std::string telemetry_str = last_log[idx++];
-  std::string event_id = last_log[idx++];
+  std::string level = last_log.level_str();
+  std::string event_id = (last_log.event_id != nullptr) ? *(last_log.event_id) : "Null";
+  bool ticketBool = last_log.creates_ticket();
 
-  bool ticketBool = false;
-  if (((level == "8") || (level == "16")) && ((cflag == "false") || (cflag == "Null")))
+  // Stream the payload, keys in the sorted order consumers have always received
+  JsonWriter &writer = JsonWriter::local();
+  writer.clear();
+  writer.begin_object();
+  writer.key("agent_id");
+  writer.string(this->agent_id);
+  writer.key("compounding");
+  if (last_log.compounding == Compounding::NO)
   {
-    ticketBool = true;
+    writer.boolean(false);
   }
-  else
+  else if (last_log.compounding == Compounding::YES)
   {
-    ticketBool = false;
+    writer.boolean(true);
   }
-
-  // Create JSON object
-  json::value payload = json::value::object();
-
-  // Create keys
-  utility::string_t agentKey(utility::conversions::to_string_t("agent_id"));
-  utility::string_t roboKey(utility::conversions::to_string_t("robot_id"));
-  utility::string_t propKey(utility::conversions::to_string_t("property_id"));
-  utility::string_t eventidKey(utility::conversions::to_string_t("event_id"));
-  utility::string_t timeKey(utility::conversions::to_string_t("timestamp"));
-  utility::string_t msgKey(utility::conversions::to_string_t("message"));
-  utility::string_t lvlKey(utility::conversions::to_string_t("level"));
-  utility::string_t modKey(utility::conversions::to_string_t("module"));
-  utility::string_t srcKey(utility::conversions::to_string_t("source"));
-  utility::string_t cKey(utility::conversions::to_string_t("compounding"));
-  utility::string_t ticketKey(utility::conversions::to_string_t("create_ticket"));
-  utility::string_t descKey(utility::conversions::to_string_t("description"));
-  utility::string_t resKey(utility::conversions::to_string_t("resolution"));
-  utility::string_t telKey(utility::conversions::to_string_t("telemetry"));
-
-  // Assign key-value
-  payload[agentKey] = json::value::string(utility::conversions::to_string_t(this->agent_id));
-  payload[roboKey] = json::value::string(utility::conversions::to_string_t(this->robot_id));
-  payload[propKey] = json::value::string(utility::conversions::to_string_t(this->site_id));
-  payload[eventidKey] = json::value::string(utility::conversions::to_string_t(event_id));
-  payload[timeKey] = json::value::string(utility::conversions::to_string_t(timestr));
-  payload[msgKey] = json::value::string(utility::conversions::to_string_t(message));
-  payload[lvlKey] = json::value::string(utility::conversions::to_string_t(level));
-  payload[modKey] = json::value::string(utility::conversions::to_string_t(module));
-  payload[srcKey] = json::value::string(utility::conversions::to_string_t(source));
-  if (cflag == "false")
-  {
-    payload[cKey] = json::value::boolean(false);
-  }
-  else if (cflag == "true")
-  {
-    payload[cKey] = json::value::boolean(true);
+  else
+  {
+    writer.string("Null");
+  }
+  writer.key("create_ticket");
+  writer.boolean(ticketBool);
+  writer.key("description");
+  writer.string(last_log.description);
+  writer.key("event_id");
+  writer.string(event_id);
+  writer.key("level");
+  writer.string(level);
+  writer.key("message");
+  writer.string(last_log.message);
+  writer.key("module");
+  writer.string(*(last_log.module));
+  writer.key("property_id");
+  writer.string(this->site_id);
+  writer.key("resolution");
+  writer.string(last_log.resolution);
+  writer.key("robot_id");
+  writer.string(this->robot_id);
+  writer.key("source");
+  writer.string(*(last_log.source));
+  writer.key("telemetry");
+  // Telemetry is already serialized, splice it in instead of parsing it back
+  if (last_log.telemetry != nullptr)
+  {
+    writer.raw(*(last_log.telemetry));
   }
   else
   {
-    payload[cKey] = json::value::string(utility::conversions::to_string_t("Null"));
+    writer.null();
   }
-  payload[ticketKey] = json::value::boolean(ticketBool);
-  payload[descKey] = json::value::string(utility::conversions::to_string_t(description));
-  payload[resKey] = json::value::string(utility::conversions::to_string_t(resolution));
-  payload[telKey] = json::value::parse(utility::conversions::to_string_t(telemetry_str));
+  writer.key("timestamp");
+  char timestr[TimestampFormatter::ISO_SIZE];
+  writer.string(timestr, TimestampFormatter::local().format_iso(last_log.time, timestr));
+  writer.end_object();
+  const std::string &payload_str = writer.str();
 
   if (this->agent_mode == "JSON_TEST")
   {
-    // Write the current JSON value to a stream with the native platform character width
-    utility::stringstream_t stream;
-    payload.serialize(stream);
-
     // Display the string stream
     // std::cout << stream.str() << std::endl;
     std::cout << level << " level event logged with id: " << event_id << std::endl;
@@ -522,15 +639,11 @@ void BackendApi::push_event_log(std::vector<std::vector<std::string>> log)
     std::string filename = this->log_name + std::to_string(this->log_id) + this->log_ext;
     std::cout << filename << std::endl;
     outfile.open(filename);
-    outfile << std::setw(4) << stream.str() << std::endl;
+    outfile << std::setw(4) << payload_str << std::endl;
     outfile.close();
   }
   else if (this->agent_mode == "POST_TEST")
   {
-    // Write the current JSON value to a stream with the native platform character width
-    utility::stringstream_t stream;
-    payload.serialize(stream);
-
     // Display the string stream
     // std::cout << stream.str() << std::endl;
     std::cout << level << " level event logged with id: " << event_id << std::endl;
@@ -541,13 +654,13 @@ void BackendApi::push_event_log(std::vector<std::vector<std::string>> log)
     std::string filename = this->log_name + std::to_string(this->log_id) + this->log_ext;
     std::cout << filename << std::endl;
     outfile.open(filename);
-    outfile << std::setw(4) << stream.str() << std::endl;
+    outfile << std::setw(4) << payload_str << std::endl;
     outfile.close();
 
     // Post downstream
     try
     {
-      this->post_event_log(payload).wait();
+      this->post_event_log(payload_str).wait();
     }
     catch (const http::http_exception &e)
     {
@@ -556,7 +669,7 @@ void BackendApi::push_event_log(std::vector<std::vector<std::string>> log)
   }
 }
 
-json::value BackendApi::create_event_log(std::vector<std::vector<std::string>> log)
+json::value BackendApi::create_event_log(const std::vector<EventRecord> &log)
 {
 
   // Create JSON object
@@ -579,30 +692,21 @@ json::value BackendApi::create_event_log(std::vector<std::vector<std::string>> l
   {
 
     // Get row
-    auto current_row = log[queue_id];
-    int idx = 0;
+    const EventRecord &current_row = log[queue_id];
 
     // Retrieve data
-    std::string timestr = current_row[idx++];
-    std::string level = current_row[idx++];
-    std::string cflag = current_row[idx++];
-    std::string module = current_row[idx++];
-    std::string source = current_row[idx++];
-    std::string message = current_row[idx++];
-    std::string description = current_row[idx++];
-    std::string resolution = current_row[idx++];
-    std::string event_id = current_row[idx++];
+    std::string event_id = (current_row.event_id != nullptr) ? *(current_row.event_id) : "Null";
     std::string qidstr = std::to_string(queue_id);
 
     // Assign key-value
-    event_log[queue_id][timeKey] = json::value::string(utility::conversions::to_string_t(timestr));
-    event_log[queue_id][lvlKey] = json::value::string(utility::conversions::to_string_t(level));
-    event_log[queue_id][cKey] = json::value::string(utility::conversions::to_string_t(cflag));
-    event_log[queue_id][modKey] = json::value::string(utility::conversions::to_string_t(module));
-    event_log[queue_id][srcKey] = json::value::string(utility::conversions::to_string_t(source));
-    event_log[queue_id][msgKey] = json::value::string(utility::conversions::to_string_t(message));
-    event_log[queue_id][descKey] = json::value::string(utility::conversions::to_string_t(description));
-    event_log[queue_id][resKey] = json::value::string(utility::conversions::to_string_t(resolution));
+    event_log[queue_id][timeKey] = json::value::string(utility::conversions::to_string_t(current_row.time_str()));
+    event_log[queue_id][lvlKey] = json::value::string(utility::conversions::to_string_t(current_row.level_str()));
+    event_log[queue_id][cKey] = json::value::string(utility::conversions::to_string_t(current_row.compounding_str()));
+    event_log[queue_id][modKey] = json::value::string(utility::conversions::to_string_t(*(current_row.module)));
+    event_log[queue_id][srcKey] = json::value::string(utility::conversions::to_string_t(*(current_row.source)));
+    event_log[queue_id][msgKey] = json::value::string(utility::conversions::to_string_t(current_row.message));
+    event_log[queue_id][descKey] = json::value::string(utility::conversions::to_string_t(current_row.description));
+    event_log[queue_id][resKey] = json::value::string(utility::conversions::to_string_t(current_row.resolution));
     event_log[queue_id][eidKey] = json::value::string(utility::conversions::to_string_t(event_id));
     event_log[queue_id][qidKey] = json::value::string(utility::conversions::to_string_t(qidstr));
   }
@@ -610,80 +714,268 @@ json::value BackendApi::create_event_log(std::vector<std::vector<std::string>> l
   return (event_log);
 }
 
-pplx::task<void> BackendApi::query_error_classification(std::string msg_text)
+pplx::task<json::value> BackendApi::query_error_classification(std::string msg_text)
 {
+  // No classification host in ROS mode
+  if (this->ecs_pool == nullptr)
+  {
+    return pplx::task_from_result(json::value::null());
+  }
+
+  // Answer "no classification" right away while the API is known to be down
+  if (!(this->ecs_breaker->allow()))
+  {
+    return pplx::task_from_result(json::value::null());
+  }
+
+  CircuitBreaker *breaker = this->ecs_breaker.get();
+
+  // New clients follow the adaptive timeout
+  this->ecs_pool->set_timeout(breaker->timeout());
+
+  // Lease a pooled client for the whole round trip. If every client is busy the lookup waits without holding a task thread,
+  // so leases can always be returned by the continuations below however many lookups are in flight.
+  return this->ecs_pool->acquire_async()
+      .then([this, msg_text, breaker](std::shared_ptr<HttpClientPool::Lease> lease) {
+        // Build request
+        http_request req(methods::GET);
+
+        // Build request URI.
+        uri_builder builder(this->ecs_api_endpoint);
+        builder.append_query("RobotModel", this->ecs_robot_model);
+        builder.append_query("ErrorText", msg_text);
+        req.set_request_uri(builder.to_string());
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        return lease->client().request(req).then([lease, breaker, start](pplx::task<http_response> response_task) {
+          try
+          {
+            return record_response(breaker, start, response_task);
+          }
+          catch (const http::http_exception &e)
+          {
+            // Transport failed, do not hand this client out again
+            lease->discard();
+            throw;
+          }
+        });
+      })
+      .then([](http_response response) {
+        // If successful, return JSON query. Each query carries its own response so concurrent queries never mix.
+        if (response.status_code() == status_codes::OK)
+        {
+          auto body = response.extract_string();
+          std::string body_str = body.get().c_str();
+          return json::value::parse(body_str);
+        }
+        // If not, request failed
+        else
+        {
+          std::cout << "Request failed" << std::endl;
+          return json::value::null();
+        }
+      });
+}
 
-  return pplx::create_task([this, msg_text] {
-           // Create HTTP client configuration
-           http_client_config config;
-           config.set_validate_certificates(false);
-           auto timeout = std::chrono::milliseconds(2000);
-           config.set_timeout(timeout);
-
-           // Create HTTP client
-           http_client client(this->ecs_api_host, config);
+pplx::task<std::vector<json::value>> BackendApi::query_error_classification_batch(const std::vector<std::string> &msg_texts)
+{
+  // Answer "no classification" for every text right away while the API is known to be down
+  if ((this->ecs_pool == nullptr) || !(this->ecs_breaker->allow()))
+  {
+    return pplx::task_from_result(std::vector<json::value>(msg_texts.size(), json::value::null()));
+  }
 
-           // Build request
-           http_request req(methods::GET);
+  CircuitBreaker *breaker = this->ecs_breaker.get();
+  size_t count = msg_texts.size();
 
-           // Build request URI.
-           uri_builder builder(this->ecs_api_endpoint);
-           builder.append_query("RobotModel", this->ecs_robot_model);
-           builder.append_query("ErrorText", msg_text);
-           req.set_request_uri(builder.to_string());
+  // New clients follow the adaptive timeout
+  this->ecs_pool->set_timeout(breaker->timeout());
 
-           return client.request(req);
-         })
-      .then([this](http_response response) {
-        // If successful, return JSON query
+  // Lease a pooled client for the whole round trip, waiting for one without holding a task thread
+  return this->ecs_pool->acquire_async()
+      .then([this, msg_texts, breaker](std::shared_ptr<HttpClientPool::Lease> lease) {
+        // Build request, every text of the batch in one body
+        json::value texts = json::value::array(msg_texts.size());
+        for (size_t idx = 0; idx < msg_texts.size(); idx++)
+        {
+          texts[idx] = json::value::string(msg_texts[idx]);
+        }
+        json::value body;
+        body[utility::conversions::to_string_t("ErrorTexts")] = texts;
+        body[utility::conversions::to_string_t("RobotModel")] = json::value::string(this->ecs_robot_model);
+
+        http_request req(methods::POST);
+        req.set_request_uri(this->ecs_api_endpoint + "batch/");
+        req.set_body(body);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        return lease->client().request(req).then([lease, breaker, start](pplx::task<http_response> response_task) {
+          try
+          {
+            return record_response(breaker, start, response_task);
+          }
+          catch (const http::http_exception &e)
+          {
+            // Transport failed, do not hand this client out again
+            lease->discard();
+            throw;
+          }
+        });
+      })
+      .then([count](http_response response) {
+        // The batch answer holds one data array per text in request order. Each is wrapped like a single query response.
+        std::vector<json::value> responses(count, json::value::null());
         if (response.status_code() == status_codes::OK)
         {
           auto body = response.extract_string();
           std::string body_str = body.get().c_str();
-          this->msg_resp = body_str;
+          json::value batch_data = json::value::parse(body_str).at(utility::conversions::to_string_t("data"));
+          for (size_t idx = 0; (idx < count) && (idx < batch_data.size()); idx++)
+          {
+            json::value single;
+            single[utility::conversions::to_string_t("data")] = batch_data[idx];
+            responses[idx] = single;
+          }
         }
-        // If not, request failed
         else
         {
           std::cout << "Request failed" << std::endl;
         }
+        return responses;
       });
 }
 
-json::value BackendApi::check_error_classification(std::string msg_text)
+pplx::task<json::value> BackendApi::classify_async(std::string msg_text)
 {
-  json::value response = json::value::null();
-  json::value response_data = json::value::null();
+  // Offline mode answers from the table snapshot, no round trip and nothing to cache
+  if (this->ecs_index != nullptr)
+  {
+    json::value row = json::value::null();
+    this->ecs_index->lookup(msg_text, row);
+    return pplx::task_from_result(row);
+  }
 
-  try
+  // Text looked up recently is answered from the cache, classified or not
+  json::value cached;
+  if ((this->ecs_cache != nullptr) && this->ecs_cache->lookup(this->ecs_robot_model, msg_text, cached))
   {
-    this->query_error_classification(msg_text).wait();
-    std::string temp_msg = this->msg_resp;
-    response = json::value::parse(temp_msg);
+    return pplx::task_from_result(cached);
   }
-  catch (const http::http_exception &e)
+
+  ClassificationCache *cache = this->ecs_cache.get();
+  std::string robot_model = this->ecs_robot_model;
+  std::string api_url = this->ecs_api_host + this->ecs_api_endpoint;
+
+  // A text that is already being queried joins that query instead of sending its own. Robot model is fixed, so the text is the key.
+  return this->ecs_flight.run(msg_text, [this, cache, robot_model, api_url, msg_text] {
+    // Batched lookups resolve to the same response document as a single query
+    pplx::task<json::value> query = (this->ecs_batcher != nullptr) ? this->ecs_batcher->submit(msg_text) : this->query_error_classification(msg_text);
+    return query.then([cache, robot_model, api_url, msg_text](pplx::task<json::value> query_task) {
+      // Errors end as "no classification" so callers waiting on the task never see an exception
+      json::value response = json::value::null();
+      try
+      {
+        response = query_task.get();
+      }
+      catch (const http::http_exception &e)
+      {
+        std::cerr << "ECS API error: " << e.what() << ". Agent will retry API connection at: " << api_url << std::endl;
+        return json::value::null();
+      }
+      catch (const json::json_exception &e)
+      {
+        return json::value::null();
+      }
+
+      try
+      {
+        // std::cout << "Trying to get data..." << std::endl;
+        json::value response_data = response.at(utility::conversions::to_string_t("data"));
+        json::value classification = response_data[0];
+
+        // Only answers the API actually gave are cached, an empty data array means the text is not in the table
+        if (cache != nullptr)
+        {
+          cache->store(robot_model, msg_text, classification);
+        }
+        return classification;
+      }
+      catch (const json::json_exception &e)
+      {
+        // Can't get data, returning null
+        return json::value::null();
+      }
+    });
+  });
+}
+
+json::value BackendApi::check_error_classification(std::string msg_text)
+{
+  // Blocking form for callers that need the answer right away
+  return this->classify_async(msg_text).get();
+}
+
+HttpClientPool *BackendApi::get_ecs_pool()
+{
+  return this->ecs_pool.get();
+}
+
+BreakerStats BackendApi::get_ecs_breaker_stats()
+{
+  // Breaker is only there when classification is on
+  if (this->ecs_breaker == nullptr)
   {
-    std::cerr << "ECS API error: " << e.what() << ". Agent will retry API connection at: " << this->ecs_api_host + this->ecs_api_endpoint << std::endl;
+    return BreakerStats();
   }
 
-  try
+  return this->ecs_breaker->get_stats();
+}
+
+RequestBatcher *BackendApi::get_ecs_batcher()
+{
+  return this->ecs_batcher.get();
+}
+
+ClassificationIndex *BackendApi::get_ecs_index()
+{
+  return this->ecs_index.get();
+}
+
+std::string BackendApi::get_agent_type()
+{
+  return this->agent_type;
+}
+
+BreakerStats BackendApi::get_post_breaker_stats()
+{
+  return this->post_breaker->get_stats();
+}
+
+ClassificationStats BackendApi::get_classification_stats()
+{
+  // Counters of the classification cache, all zero in ROS mode
+  if (this->ecs_cache == nullptr)
   {
-    // std::cout << "Trying to get data..." << std::endl;
-    response_data = response.at(utility::conversions::to_string_t("data"));
+    return ClassificationStats();
+  }
 
-    // // Write the current JSON value to a stream with the native platform character width
-    // utility::stringstream_t stream;
-    // response_data.serialize(stream);
+  ClassificationStats stats = this->ecs_cache->get_stats();
+  stats.coalesced = this->ecs_flight.coalesced_count();
+  return stats;
+}
 
-    // Display the string stream
-    // std::cout << "Get data: " << stream.str() << std::endl;
-    return response_data[0];
+bool BackendApi::save_classification_cache()
+{
+  // Nothing to keep in ROS mode
+  if (this->ecs_cache == nullptr)
+  {
+    return true;
   }
-  catch (const json::json_exception &e)
+
+  if (!(this->ecs_cache->save(this->ecs_cache_file)))
   {
-    // const std::exception& e
-    // std::cout << " Can't get data, returning null" << std::endl;
-    // response_data = json::value::null();
-    return response_data;
+    std::cerr << "Could not save ECS cache to: " << this->ecs_cache_file << std::endl;
+    return false;
   }
+  return true;
 }
@@ -0,0 +1,159 @@
+#include <error_resolution_diagnoser/circuit_breaker.h>
+#include <algorithm>
+#include <iostream>
+
+const size_t CircuitBreaker::LATENCY_WINDOW;
+const size_t CircuitBreaker::MIN_SAMPLES;
+
+CircuitBreaker::CircuitBreaker(std::string name, size_t failure_threshold, std::chrono::milliseconds open_time, std::chrono::milliseconds max_timeout)
+{
+    this->name = name;
+    this->failure_threshold = (failure_threshold > 0) ? failure_threshold : 1;
+    this->base_open_time = open_time;
+    this->open_time = open_time;
+    this->max_timeout = max_timeout;
+    this->min_timeout = max_timeout / 10;
+    this->current_timeout = max_timeout;
+    this->state = BreakerState::CLOSED;
+    this->consecutive_failures = 0;
+    this->latencies.reserve(LATENCY_WINDOW);
+    this->next_latency = 0;
+    this->stats.state = BreakerState::CLOSED;
+    this->stats.successes = 0;
+    this->stats.failures = 0;
+    this->stats.rejected = 0;
+    this->stats.trips = 0;
+    this->stats.timeout = max_timeout;
+}
+
+bool CircuitBreaker::allow()
+{
+    std::lock_guard<std::mutex> lock(this->breaker_mutex);
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    if (this->state == BreakerState::OPEN)
+    {
+        // Let one probe through once the open time has passed
+        if ((now - this->opened_at) >= this->open_time)
+        {
+            this->state = BreakerState::HALF_OPEN;
+            this->probe_started = now;
+            return true;
+        }
+    }
+    else if (this->state == BreakerState::HALF_OPEN)
+    {
+        // Only one probe at a time, unless the last one never reported back
+        if ((now - this->probe_started) > this->max_timeout)
+        {
+            this->probe_started = now;
+            return true;
+        }
+    }
+    else
+    {
+        return true;
+    }
+
+    this->stats.rejected++;
+    return false;
+}
+
+void CircuitBreaker::record_success(std::chrono::milliseconds latency)
+{
+    std::lock_guard<std::mutex> lock(this->breaker_mutex);
+    this->stats.successes++;
+
+    // Any response shows the endpoint is back
+    if (this->state != BreakerState::CLOSED)
+    {
+        std::cerr << this->name << " is reachable again. Resuming requests." << std::endl;
+    }
+    this->state = BreakerState::CLOSED;
+    this->consecutive_failures = 0;
+    this->open_time = this->base_open_time;
+
+    uint32_t latency_ms = static_cast<uint32_t>(std::max<int64_t>(latency.count(), 0));
+    if (this->latencies.size() < LATENCY_WINDOW)
+    {
+        this->latencies.push_back(latency_ms);
+    }
+    else
+    {
+        this->latencies[this->next_latency] = latency_ms;
+    }
+    this->next_latency = (this->next_latency + 1) % LATENCY_WINDOW;
+    this->adapt_timeout();
+}
+
+void CircuitBreaker::record_failure()
+{
+    std::lock_guard<std::mutex> lock(this->breaker_mutex);
+    this->stats.failures++;
+
+    // Give the next request more time in case the endpoint only got slower
+    this->current_timeout = std::min(this->current_timeout * 2, this->max_timeout);
+
+    if (this->state == BreakerState::HALF_OPEN)
+    {
+        // Probe failed, stay open for longer
+        this->open_time = std::min(this->open_time * 2, this->base_open_time * 16);
+        this->state = BreakerState::OPEN;
+        this->opened_at = std::chrono::steady_clock::now();
+    }
+    else if (this->state == BreakerState::CLOSED)
+    {
+        this->consecutive_failures++;
+        if (this->consecutive_failures >= this->failure_threshold)
+        {
+            this->state = BreakerState::OPEN;
+            this->opened_at = std::chrono::steady_clock::now();
+            this->stats.trips++;
+            std::cerr << this->name << " failed " << this->consecutive_failures << " times in a row. Requests are paused for "
+                      << this->open_time.count() << " ms before probing again." << std::endl;
+        }
+    }
+}
+
+void CircuitBreaker::adapt_timeout()
+{
+    if (this->latencies.size() < MIN_SAMPLES)
+    {
+        return;
+    }
+
+    // 99th percentile of recent response times
+    std::vector<uint32_t> sorted(this->latencies);
+    size_t rank = (sorted.size() * 99) / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    std::chrono::milliseconds target(4 * static_cast<int64_t>(sorted[rank]));
+    target = std::max(this->min_timeout, std::min(target, this->max_timeout));
+
+    // Small changes are ignored so connections built with the current timeout stay in use
+    std::chrono::milliseconds diff = (target > this->current_timeout) ? (target - this->current_timeout) : (this->current_timeout - target);
+    if ((diff * 4) > this->current_timeout)
+    {
+        this->current_timeout = target;
+    }
+}
+
+std::chrono::milliseconds CircuitBreaker::timeout()
+{
+    std::lock_guard<std::mutex> lock(this->breaker_mutex);
+    return this->current_timeout;
+}
+
+BreakerState CircuitBreaker::get_state()
+{
+    std::lock_guard<std::mutex> lock(this->breaker_mutex);
+    return this->state;
+}
+
+BreakerStats CircuitBreaker::get_stats()
+{
+    std::lock_guard<std::mutex> lock(this->breaker_mutex);
+    BreakerStats current = this->stats;
+    current.state = this->state;
+    current.timeout = this->current_timeout;
+    return current;
+}
@@ -0,0 +1,316 @@
+#include <error_resolution_diagnoser/classification_artifact.h>
+#include <error_resolution_diagnoser/atomic_file.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+// File layout: header, hash index slots, row records, string pool. Every section starts 8-byte aligned and
+// offsets are from the start of the file. Integers are in host byte order, checked through the byte order mark.
+static const char ARTIFACT_MAGIC[8] = {'E', 'C', 'S', 'T', 'A', 'B', 'L', 'E'};
+static const uint32_t ARTIFACT_VERSION = 1;
+static const uint32_t ARTIFACT_BYTE_ORDER = 0x01020304;
+
+struct ArtifactHeader
+{
+    char magic[8];         // ARTIFACT_MAGIC
+    uint32_t version;      // ARTIFACT_VERSION
+    uint32_t byte_order;   // ARTIFACT_BYTE_ORDER as written by the compiler
+    uint64_t file_size;    // Size of the whole artifact
+    uint64_t slot_offset;  // Hash index
+    uint64_t slot_count;   // Power of two, larger than the row count so every probe ends on an empty slot
+    uint64_t row_offset;   // Row records
+    uint64_t row_count;    // Number of rows
+    uint64_t pool_offset;  // String pool
+    uint64_t pool_size;    // Bytes in the string pool
+    uint32_t model_offset; // Robot model the artifact was compiled for, in the pool
+    uint32_t model_length;
+};
+
+struct ArtifactSlot
+{
+    uint64_t hash; // Hash of the error text
+    uint64_t row;  // Row index plus one, 0 for an empty slot
+};
+
+struct ArtifactRow
+{
+    uint32_t text_offset; // Error text in the pool
+    uint32_t text_length;
+    uint32_t row_offset;  // Serialized row in the pool
+    uint32_t row_length;
+};
+
+static uint64_t hash_text(const char *text, size_t length)
+{
+    // FNV-1a, part of the format so it must not change within a version
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t idx = 0; idx < length; idx++)
+    {
+        hash ^= static_cast<unsigned char>(text[idx]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t align8(uint64_t offset)
+{
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+static bool section_fits(uint64_t offset, uint64_t count, uint64_t item_size, uint64_t file_size)
+{
+    // Overflow safe offset + count * item_size <= file_size
+    return (offset <= file_size) && (count <= (file_size - offset) / item_size);
+}
+
+ClassificationArtifact::ClassificationArtifact()
+{
+    this->base = nullptr;
+    this->length = 0;
+    this->slots = nullptr;
+    this->slot_count = 0;
+    this->rows = nullptr;
+    this->row_count = 0;
+    this->pool = nullptr;
+    this->pool_size = 0;
+}
+
+ClassificationArtifact::~ClassificationArtifact()
+{
+    this->close();
+}
+
+void ClassificationArtifact::close()
+{
+    if (this->base != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(this->base), this->length);
+    }
+    this->base = nullptr;
+    this->length = 0;
+    this->slots = nullptr;
+    this->slot_count = 0;
+    this->rows = nullptr;
+    this->row_count = 0;
+    this->pool = nullptr;
+    this->pool_size = 0;
+}
+
+bool ClassificationArtifact::is_artifact(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(ARTIFACT_MAGIC)];
+    return in.read(magic, sizeof(magic)) && (memcmp(magic, ARTIFACT_MAGIC, sizeof(magic)) == 0);
+}
+
+bool ClassificationArtifact::write(const std::string &path, const std::string &robot_model,
+                                   const std::unordered_map<std::string, json::value> &table_rows)
+{
+    // String pool starts with the robot model, then the text and serialized row of every row
+    std::string pool_data = robot_model;
+    std::vector<ArtifactRow> records;
+    std::vector<uint64_t> hashes;
+    records.reserve(table_rows.size());
+    hashes.reserve(table_rows.size());
+    for (const auto &entry : table_rows)
+    {
+        std::string row_str = utility::conversions::to_utf8string(entry.second.serialize());
+        if ((pool_data.size() + entry.first.size() + row_str.size()) > UINT32_MAX)
+        {
+            std::cerr << "Classification table is too large for an artifact." << std::endl;
+            return false;
+        }
+
+        ArtifactRow record;
+        record.text_offset = static_cast<uint32_t>(pool_data.size());
+        record.text_length = static_cast<uint32_t>(entry.first.size());
+        pool_data += entry.first;
+        record.row_offset = static_cast<uint32_t>(pool_data.size());
+        record.row_length = static_cast<uint32_t>(row_str.size());
+        pool_data += row_str;
+        records.push_back(record);
+        hashes.push_back(hash_text(entry.first.data(), entry.first.size()));
+    }
+
+    // At most half full, so probes stay short
+    uint64_t slot_count = 2;
+    while (slot_count < (2 * records.size()))
+    {
+        slot_count *= 2;
+    }
+    std::vector<ArtifactSlot> slot_data(slot_count, ArtifactSlot{0, 0});
+    for (size_t idx = 0; idx < records.size(); idx++)
+    {
+        uint64_t slot = hashes[idx] & (slot_count - 1);
+        while (slot_data[slot].row != 0)
+        {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slot_data[slot].hash = hashes[idx];
+        slot_data[slot].row = idx + 1;
+    }
+
+    ArtifactHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARTIFACT_MAGIC, sizeof(ARTIFACT_MAGIC));
+    header.version = ARTIFACT_VERSION;
+    header.byte_order = ARTIFACT_BYTE_ORDER;
+    header.slot_offset = align8(sizeof(ArtifactHeader));
+    header.slot_count = slot_count;
+    header.row_offset = align8(header.slot_offset + slot_count * sizeof(ArtifactSlot));
+    header.row_count = records.size();
+    header.pool_offset = align8(header.row_offset + records.size() * sizeof(ArtifactRow));
+    header.pool_size = pool_data.size();
+    header.model_offset = 0;
+    header.model_length = static_cast<uint32_t>(robot_model.size());
+    header.file_size = header.pool_offset + header.pool_size;
+
+    // Padding between sections stays zero
+    std::string contents(header.file_size, '\0');
+    memcpy(&contents[0], &header, sizeof(header));
+    memcpy(&contents[header.slot_offset], slot_data.data(), slot_count * sizeof(ArtifactSlot));
+    memcpy(&contents[header.row_offset], records.data(), records.size() * sizeof(ArtifactRow));
+    memcpy(&contents[header.pool_offset], pool_data.data(), pool_data.size());
+
+    // Replaced in one rename, so agents that still map the old artifact keep a consistent view
+    if (!write_file_atomic(path, contents))
+    {
+        std::cerr << "Could not write classification artifact: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+size_t ClassificationArtifact::open(const std::string &path, const std::string &robot_model)
+{
+    this->close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cerr << "Could not open classification artifact: " << path << std::endl;
+        return 0;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (static_cast<uint64_t>(st.st_size) < sizeof(ArtifactHeader)))
+    {
+        ::close(fd);
+        std::cerr << "Classification artifact is truncated: " << path << std::endl;
+        return 0;
+    }
+
+    // Shared read-only mapping, pages come from the page cache and are shared with every other agent mapping the file
+    size_t file_size = static_cast<size_t>(st.st_size);
+    void *mapping = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Could not map classification artifact: " << path << std::endl;
+        return 0;
+    }
+    this->base = static_cast<const uint8_t *>(mapping);
+    this->length = file_size;
+
+    // Only the header is checked, so opening takes the same time whatever the table size
+    const ArtifactHeader *header = reinterpret_cast<const ArtifactHeader *>(this->base);
+    if ((memcmp(header->magic, ARTIFACT_MAGIC, sizeof(ARTIFACT_MAGIC)) != 0) || (header->version != ARTIFACT_VERSION) ||
+        (header->byte_order != ARTIFACT_BYTE_ORDER))
+    {
+        std::cerr << "Classification artifact has an unsupported format, recompile it: " << path << std::endl;
+        this->close();
+        return 0;
+    }
+    if ((header->file_size != file_size) || (header->slot_count == 0) || ((header->slot_count & (header->slot_count - 1)) != 0) ||
+        (header->row_count >= header->slot_count) || ((header->slot_offset | header->row_offset | header->pool_offset) & 7) ||
+        !section_fits(header->slot_offset, header->slot_count, sizeof(ArtifactSlot), file_size) ||
+        !section_fits(header->row_offset, header->row_count, sizeof(ArtifactRow), file_size) ||
+        !section_fits(header->pool_offset, header->pool_size, 1, file_size) ||
+        (static_cast<uint64_t>(header->model_offset) + header->model_length > header->pool_size))
+    {
+        std::cerr << "Classification artifact is corrupt: " << path << std::endl;
+        this->close();
+        return 0;
+    }
+
+    const char *pool_start = reinterpret_cast<const char *>(this->base + header->pool_offset);
+    std::string artifact_model(pool_start + header->model_offset, header->model_length);
+    if (artifact_model != robot_model)
+    {
+        std::cerr << "Classification artifact was compiled for robot model " << artifact_model << ", not " << robot_model << ": " << path << std::endl;
+        this->close();
+        return 0;
+    }
+
+    // Lookups go to random rows
+    madvise(mapping, file_size, MADV_RANDOM);
+
+    this->slots = this->base + header->slot_offset;
+    this->slot_count = header->slot_count;
+    this->rows = this->base + header->row_offset;
+    this->row_count = header->row_count;
+    this->pool = pool_start;
+    this->pool_size = header->pool_size;
+    return this->row_count;
+}
+
+bool ClassificationArtifact::lookup(const std::string &msg_text, json::value &row) const
+{
+    if (this->row_count == 0)
+    {
+        return false;
+    }
+
+    const ArtifactSlot *slot_data = static_cast<const ArtifactSlot *>(this->slots);
+    const ArtifactRow *records = static_cast<const ArtifactRow *>(this->rows);
+    uint64_t hash = hash_text(msg_text.data(), msg_text.size());
+    for (uint64_t probe = 0; probe < this->slot_count; probe++)
+    {
+        const ArtifactSlot &slot = slot_data[(hash + probe) & (this->slot_count - 1)];
+        if (slot.row == 0)
+        {
+            return false;
+        }
+        if ((slot.hash != hash) || (slot.row > this->row_count))
+        {
+            continue;
+        }
+
+        // Offsets are checked on use since the header check does not walk the rows
+        const ArtifactRow &record = records[slot.row - 1];
+        if ((static_cast<uint64_t>(record.text_offset) + record.text_length > this->pool_size) ||
+            (static_cast<uint64_t>(record.row_offset) + record.row_length > this->pool_size))
+        {
+            return false;
+        }
+        if ((record.text_length != msg_text.size()) || (memcmp(this->pool + record.text_offset, msg_text.data(), msg_text.size()) != 0))
+        {
+            continue;
+        }
+
+        try
+        {
+            row = json::value::parse(utility::conversions::to_string_t(std::string(this->pool + record.row_offset, record.row_length)));
+        }
+        catch (const json::json_exception &e)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+size_t ClassificationArtifact::size() const
+{
+    return this->row_count;
+}
@@ -0,0 +1,268 @@
+#include <error_resolution_diagnoser/classification_cache.h>
+#include <error_resolution_diagnoser/atomic_file.h>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+// File layout: magic, format version, configuration, entry count, then per entry the expiry in wall clock
+// milliseconds, the key and the serialized value (empty for "not in the table"). Lengths are 32-bit.
+static const char CACHE_FILE_MAGIC[4] = {'E', 'C', 'S', 'C'};
+static const uint32_t CACHE_FILE_VERSION = 1;
+static const uint32_t CACHE_FILE_MAX_FIELD = 1 << 20;
+
+template <typename T>
+static void write_pod(std::ostream &out, T value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void write_field(std::ostream &out, const std::string &field)
+{
+    write_pod<uint32_t>(out, static_cast<uint32_t>(field.size()));
+    out.write(field.data(), field.size());
+}
+
+template <typename T>
+static bool read_pod(std::ifstream &in, T &value)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+static bool read_field(std::ifstream &in, std::string &field)
+{
+    // Bound the length so a corrupt file cannot ask for a huge allocation
+    uint32_t len = 0;
+    if (!read_pod(in, len) || (len > CACHE_FILE_MAX_FIELD))
+    {
+        return false;
+    }
+    field.resize(len);
+    return (len == 0) || static_cast<bool>(in.read(&field[0], len));
+}
+
+static int64_t wall_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+ClassificationCache::ClassificationCache(const std::string &config, size_t capacity, std::chrono::milliseconds hit_ttl, std::chrono::milliseconds miss_ttl)
+{
+    this->config = config;
+    this->capacity = (capacity > 0) ? capacity : 1;
+    this->hit_ttl = hit_ttl;
+    this->miss_ttl = miss_ttl;
+    this->stats.entries = 0;
+    this->stats.hits = 0;
+    this->stats.negative = 0;
+    this->stats.misses = 0;
+    this->stats.evictions = 0;
+    this->stats.coalesced = 0;
+}
+
+std::string ClassificationCache::make_key(const std::string &robot_model, const std::string &msg_text)
+{
+    // Robot model never contains a NUL, so the key is unambiguous
+    std::string key;
+    key.reserve(robot_model.size() + 1 + msg_text.size());
+    key.append(robot_model);
+    key.push_back('\0');
+    key.append(msg_text);
+    return key;
+}
+
+bool ClassificationCache::lookup(const std::string &robot_model, const std::string &msg_text, json::value &value)
+{
+    std::string key = make_key(robot_model, msg_text);
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+    auto found = this->index.find(key);
+    if (found == this->index.end())
+    {
+        this->stats.misses++;
+        return false;
+    }
+
+    // Stale entries are dropped and count as a miss
+    if (std::chrono::steady_clock::now() >= found->second->expiry)
+    {
+        this->entries.erase(found->second);
+        this->index.erase(found);
+        this->stats.misses++;
+        return false;
+    }
+
+    // Move to the front as most recently used
+    this->entries.splice(this->entries.begin(), this->entries, found->second);
+    value = found->second->value;
+    if (value.is_null())
+    {
+        this->stats.negative++;
+    }
+    else
+    {
+        this->stats.hits++;
+    }
+    return true;
+}
+
+void ClassificationCache::store(const std::string &robot_model, const std::string &msg_text, const json::value &value)
+{
+    std::string key = make_key(robot_model, msg_text);
+    std::chrono::steady_clock::time_point expiry = std::chrono::steady_clock::now() + (value.is_null() ? this->miss_ttl : this->hit_ttl);
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+    auto found = this->index.find(key);
+    if (found != this->index.end())
+    {
+        // Refresh in place
+        found->second->value = value;
+        found->second->expiry = expiry;
+        this->entries.splice(this->entries.begin(), this->entries, found->second);
+        return;
+    }
+
+    // Make room by dropping the least recently used entry
+    if (this->entries.size() >= this->capacity)
+    {
+        this->index.erase(this->entries.back().key);
+        this->entries.pop_back();
+        this->stats.evictions++;
+    }
+
+    CacheEntry entry;
+    entry.key = key;
+    entry.value = value;
+    entry.expiry = expiry;
+    this->entries.push_front(std::move(entry));
+    this->index[key] = this->entries.begin();
+}
+
+void ClassificationCache::clear()
+{
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+    this->entries.clear();
+    this->index.clear();
+}
+
+bool ClassificationCache::save(const std::string &path)
+{
+    std::unique_lock<std::mutex> lock(this->cache_mutex);
+
+    // Expiry is kept on the steady clock, which does not survive a restart, so store it as wall clock time
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    int64_t now_wall = wall_ms();
+    uint32_t count = 0;
+    for (const CacheEntry &entry : this->entries)
+    {
+        if (entry.expiry > now)
+        {
+            count++;
+        }
+    }
+
+    std::ostringstream out(std::ios::binary);
+    out.write(CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+    write_pod<uint32_t>(out, CACHE_FILE_VERSION);
+    write_field(out, this->config);
+    write_pod<uint32_t>(out, count);
+
+    // Most recently used first, so loading into a smaller cache keeps the most useful entries
+    for (const CacheEntry &entry : this->entries)
+    {
+        if (entry.expiry <= now)
+        {
+            continue;
+        }
+        int64_t remaining = std::chrono::duration_cast<std::chrono::milliseconds>(entry.expiry - now).count();
+        write_pod<int64_t>(out, now_wall + remaining);
+        write_field(out, entry.key);
+        write_field(out, entry.value.is_null() ? std::string() : utility::conversions::to_utf8string(entry.value.serialize()));
+    }
+
+    // Lookups carry on while the file is written. Agents on the same host share the file, each replaces it whole
+    // so a crash or a concurrent save never leaves it truncated.
+    lock.unlock();
+    return write_file_atomic(path, out.str());
+}
+
+size_t ClassificationCache::load(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        return 0;
+    }
+
+    // Files from another format or configuration are ignored
+    char magic[sizeof(CACHE_FILE_MAGIC)];
+    uint32_t version = 0;
+    std::string config;
+    uint32_t count = 0;
+    if (!in.read(magic, sizeof(magic)) || (memcmp(magic, CACHE_FILE_MAGIC, sizeof(magic)) != 0) ||
+        !read_pod(in, version) || (version != CACHE_FILE_VERSION) || !read_field(in, config) || !read_pod(in, count))
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+    if (config != this->config)
+    {
+        return 0;
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    int64_t now_wall = wall_ms();
+    size_t loaded = 0;
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        int64_t expiry_wall = 0;
+        std::string key;
+        std::string value_str;
+        if (!read_pod(in, expiry_wall) || !read_field(in, key) || !read_field(in, value_str))
+        {
+            // Truncated or corrupt, keep what was read so far
+            break;
+        }
+
+        // Skip entries that expired while the agent was down, or that are already cached
+        if ((expiry_wall <= now_wall) || (this->index.find(key) != this->index.end()) || (this->entries.size() >= this->capacity))
+        {
+            continue;
+        }
+
+        CacheEntry entry;
+        entry.key = key;
+        try
+        {
+            entry.value = value_str.empty() ? json::value::null() : json::value::parse(utility::conversions::to_string_t(value_str));
+        }
+        catch (const json::json_exception &e)
+        {
+            continue;
+        }
+
+        // TTLs may have been shortened since the file was written
+        std::chrono::milliseconds remaining(expiry_wall - now_wall);
+        std::chrono::milliseconds ttl = entry.value.is_null() ? this->miss_ttl : this->hit_ttl;
+        entry.expiry = now + ((remaining < ttl) ? remaining : ttl);
+
+        // File is most recently used first, so append to keep the order
+        this->entries.push_back(std::move(entry));
+        this->index[key] = std::prev(this->entries.end());
+        loaded++;
+    }
+
+    return loaded;
+}
+
+ClassificationStats ClassificationCache::get_stats()
+{
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+    ClassificationStats current = this->stats;
+    current.entries = this->entries.size();
+    return current;
+}
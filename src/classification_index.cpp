@@ -0,0 +1,114 @@
+#include <error_resolution_diagnoser/classification_index.h>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+ClassificationIndex::ClassificationIndex()
+{
+}
+
+size_t ClassificationIndex::load(const std::string &path, const std::string &robot_model)
+{
+    // Compiled artifacts are mapped in place, shared with every agent on the host
+    if (ClassificationArtifact::is_artifact(path))
+    {
+        this->artifact.reset(new ClassificationArtifact());
+        size_t mapped = this->artifact->open(path, robot_model);
+        if (mapped == 0)
+        {
+            this->artifact.reset();
+        }
+        return mapped;
+    }
+
+    std::ifstream in(path);
+    if (!in)
+    {
+        std::cerr << "Could not open classification table: " << path << std::endl;
+        return 0;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+
+    json::value table;
+    try
+    {
+        table = json::value::parse(utility::conversions::to_string_t(contents.str()));
+        // Snapshot may be saved straight from an API answer
+        if (table.is_object())
+        {
+            json::value table_rows = table.at(utility::conversions::to_string_t("data"));
+            table = table_rows;
+        }
+    }
+    catch (const json::json_exception &e)
+    {
+        std::cerr << "Classification table is not valid JSON: " << path << ". " << e.what() << std::endl;
+        return 0;
+    }
+    if (!(table.is_array()))
+    {
+        std::cerr << "Classification table has no rows: " << path << std::endl;
+        return 0;
+    }
+
+    const utility::string_t text_key = utility::conversions::to_string_t("error_text");
+    const utility::string_t model_key = utility::conversions::to_string_t("robot_model");
+    size_t loaded = 0;
+    for (const json::value &row : table.as_array())
+    {
+        // Skip rows that cannot be matched or belong to another robot model
+        if (!(row.is_object()) || !(row.has_field(text_key)) || !(row.at(text_key).is_string()))
+        {
+            continue;
+        }
+        if (row.has_field(model_key) && row.at(model_key).is_string() &&
+            (utility::conversions::to_utf8string(row.at(model_key).as_string()) != robot_model))
+        {
+            continue;
+        }
+
+        // First row of a text wins, like the first row of an API answer
+        if (this->rows.emplace(utility::conversions::to_utf8string(row.at(text_key).as_string()), row).second)
+        {
+            loaded++;
+        }
+    }
+
+    return loaded;
+}
+
+bool ClassificationIndex::lookup(const std::string &msg_text, json::value &row) const
+{
+    if (this->artifact != nullptr)
+    {
+        return this->artifact->lookup(msg_text, row);
+    }
+
+    auto found = this->rows.find(msg_text);
+    if (found == this->rows.end())
+    {
+        return false;
+    }
+
+    row = found->second;
+    return true;
+}
+
+size_t ClassificationIndex::size() const
+{
+    return (this->artifact != nullptr) ? this->artifact->size() : this->rows.size();
+}
+
+bool ClassificationIndex::is_mapped() const
+{
+    return (this->artifact != nullptr);
+}
+
+const std::unordered_map<std::string, json::value> &ClassificationIndex::get_rows() const
+{
+    return this->rows;
+}
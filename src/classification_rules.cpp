@@ -0,0 +1,130 @@
+#include <error_resolution_diagnoser/classification_rules.h>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+static bool rule_kind_from_string(const std::string &match, RuleKind &kind)
+{
+    // Match types accepted in a rules file
+    if (match == "contains")
+    {
+        kind = RuleKind::CONTAINS;
+    }
+    else if (match == "prefix")
+    {
+        kind = RuleKind::PREFIX;
+    }
+    else if (match == "suffix")
+    {
+        kind = RuleKind::SUFFIX;
+    }
+    else if (match == "exact")
+    {
+        kind = RuleKind::EXACT;
+    }
+    else if (match == "glob")
+    {
+        kind = RuleKind::GLOB;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+ClassificationRules::ClassificationRules()
+{
+}
+
+size_t ClassificationRules::load(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        std::cerr << "Could not open classification rules: " << path << std::endl;
+        return 0;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+
+    json::value rules;
+    try
+    {
+        rules = json::value::parse(utility::conversions::to_string_t(contents.str()));
+    }
+    catch (const json::json_exception &e)
+    {
+        std::cerr << "Classification rules are not valid JSON: " << path << ". " << e.what() << std::endl;
+        return 0;
+    }
+    if (!(rules.is_array()))
+    {
+        std::cerr << "Classification rules are not a list: " << path << std::endl;
+        return 0;
+    }
+
+    const utility::string_t pattern_key = utility::conversions::to_string_t("pattern");
+    const utility::string_t match_key = utility::conversions::to_string_t("match");
+    const utility::string_t severity_key = utility::conversions::to_string_t("severity");
+    const utility::string_t cflag_key = utility::conversions::to_string_t("compounding_flag");
+    const utility::string_t module_key = utility::conversions::to_string_t("error_module");
+    const utility::string_t source_key = utility::conversions::to_string_t("error_source");
+    const utility::string_t text_key = utility::conversions::to_string_t("error_text");
+    size_t index = 0;
+    for (const json::value &rule : rules.as_array())
+    {
+        index++;
+
+        // Skip rules that cannot be matched or classify nothing
+        if (!(rule.is_object()) || !(rule.has_field(pattern_key)) || !(rule.at(pattern_key).is_string()) ||
+            !(rule.has_field(severity_key)) || !(rule.at(severity_key).is_integer()))
+        {
+            std::cerr << "Skipping classification rule " << index << ": pattern and severity are required." << std::endl;
+            continue;
+        }
+        RuleKind kind = RuleKind::CONTAINS;
+        if (rule.has_field(match_key) &&
+            (!(rule.at(match_key).is_string()) || !rule_kind_from_string(utility::conversions::to_utf8string(rule.at(match_key).as_string()), kind)))
+        {
+            std::cerr << "Skipping classification rule " << index << ": match is not one of contains, prefix, suffix, exact or glob." << std::endl;
+            continue;
+        }
+
+        // Same fields as an ECS row, so rule hits go through the ECS message cycle
+        json::value row;
+        row[text_key] = (rule.has_field(text_key) && rule.at(text_key).is_string()) ? rule.at(text_key) : rule.at(pattern_key);
+        row[severity_key] = rule.at(severity_key);
+        row[cflag_key] = (rule.has_field(cflag_key) && rule.at(cflag_key).is_boolean()) ? rule.at(cflag_key) : json::value::boolean(false);
+        row[module_key] = (rule.has_field(module_key) && rule.at(module_key).is_string()) ? rule.at(module_key) : json::value::string(utility::conversions::to_string_t("Null"));
+        row[source_key] = (rule.has_field(source_key) && rule.at(source_key).is_string()) ? rule.at(source_key) : json::value::string(utility::conversions::to_string_t("Null"));
+
+        this->matcher.add_rule(utility::conversions::to_utf8string(rule.at(pattern_key).as_string()), kind);
+        this->rows.push_back(row);
+    }
+
+    // Compiled once here, lookups afterwards only walk the automata
+    this->matcher.compile();
+    return this->rows.size();
+}
+
+bool ClassificationRules::classify(const std::string &msg_text, json::value &row)
+{
+    int32_t id = this->matcher.match(msg_text);
+    if (id < 0)
+    {
+        return false;
+    }
+
+    row = this->rows[id];
+    return true;
+}
+
+size_t ClassificationRules::size() const
+{
+    return this->rows.size();
+}
@@ -0,0 +1,40 @@
+#include <error_resolution_diagnoser/classification_index.h>
+#include <error_resolution_diagnoser/classification_artifact.h>
+#include <iostream>
+
+// Offline compiler from an exported classification table to the artifact agents map at startup through
+// ECS_TABLE_FILE. Usage: compile_classification_table <table.json> <robot model> <artifact>
+
+int main(int argc, char **argv)
+{
+    if (argc != 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <table.json> <robot model> <artifact>" << std::endl;
+        return 1;
+    }
+    std::string table_file = argv[1];
+    std::string robot_model = argv[2];
+    std::string artifact_file = argv[3];
+
+    // Same rows the agent would index from the snapshot for this robot model
+    ClassificationIndex index;
+    size_t rows = index.load(table_file, robot_model);
+    if (index.is_mapped())
+    {
+        std::cerr << "Input is already a compiled artifact: " << table_file << std::endl;
+        return 1;
+    }
+    if (rows == 0)
+    {
+        std::cerr << "No rows to compile for robot model " << robot_model << " in: " << table_file << std::endl;
+        return 1;
+    }
+
+    if (!ClassificationArtifact::write(artifact_file, robot_model, index.get_rows()))
+    {
+        return 1;
+    }
+
+    std::cout << "Compiled " << rows << " rows for robot model " << robot_model << " into: " << artifact_file << std::endl;
+    return 0;
+}
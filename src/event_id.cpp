@@ -0,0 +1,116 @@
+#include <error_resolution_diagnoser/event_id.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+EventIdGenerator::EventIdGenerator()
+{
+    // Seed the whole engine state from the OS entropy source, this is the expensive part and happens once
+    std::random_device device;
+    std::seed_seq seed{device(), device(), device(), device(), device(), device(), device(), device()};
+    this->engine.seed(seed);
+
+    this->last_ms = 0;
+    this->sequence = 0;
+}
+
+void EventIdGenerator::next_bytes(EventIdFormat id_format, uint64_t now_ms, uint8_t *bytes)
+{
+    uint64_t high = this->engine();
+    uint64_t low = this->engine();
+
+    if (id_format == EventIdFormat::UUID7)
+    {
+        // Sequence restarts from a random point each millisecond. On overflow borrow the next millisecond
+        // and if the clock went back stay on the last one, so IDs from this thread never go backwards.
+        if (now_ms > this->last_ms)
+        {
+            this->last_ms = now_ms;
+            this->sequence = (high >> 52) & 0x7FF;
+        }
+        else if (this->sequence < 0xFFF)
+        {
+            this->sequence++;
+        }
+        else
+        {
+            this->last_ms++;
+            this->sequence = 0;
+        }
+
+        // unix_ts_ms (48) | ver (4) | rand_a (12)
+        high = (this->last_ms << 16) | (uint64_t(0x7) << 12) | this->sequence;
+    }
+    else
+    {
+        // ver (4) in bits 12-15 of the third group
+        high = (high & 0xFFFFFFFFFFFF0FFFULL) | (uint64_t(0x4) << 12);
+    }
+
+    // var (2) is 0b10
+    low = (low & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+
+    for (int idx = 0; idx < 8; idx++)
+    {
+        bytes[idx] = static_cast<uint8_t>(high >> (56 - 8 * idx));
+        bytes[8 + idx] = static_cast<uint8_t>(low >> (56 - 8 * idx));
+    }
+}
+
+std::string EventIdGenerator::next(EventIdFormat id_format)
+{
+    uint64_t now_ms = 0;
+    if (id_format == EventIdFormat::UUID7)
+    {
+        now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+    }
+
+    uint8_t bytes[16];
+    this->next_bytes(id_format, now_ms, bytes);
+    return format(bytes);
+}
+
+std::string EventIdGenerator::format(const uint8_t *bytes)
+{
+    // 8-4-4-4-12 lowercase hex, same text as boost::uuids::to_string
+    static const char digits[] = "0123456789abcdef";
+    char text[36];
+    int pos = 0;
+
+    for (int idx = 0; idx < 16; idx++)
+    {
+        if ((idx == 4) || (idx == 6) || (idx == 8) || (idx == 10))
+        {
+            text[pos++] = '-';
+        }
+        text[pos++] = digits[bytes[idx] >> 4];
+        text[pos++] = digits[bytes[idx] & 0x0F];
+    }
+
+    return std::string(text, sizeof(text));
+}
+
+EventIdGenerator &EventIdGenerator::local()
+{
+    thread_local EventIdGenerator generator;
+    return generator;
+}
+
+EventIdFormat EventIdGenerator::format_from_env()
+{
+    // Random IDs unless time ordered ones are asked for
+    if (std::getenv("EVENT_ID_FORMAT"))
+    {
+        std::string id_format = std::getenv("EVENT_ID_FORMAT");
+        if ((id_format == "UUID4") || (id_format == "UUID7"))
+        {
+            std::cout << "EVENT_ID_FORMAT: " << id_format << std::endl;
+            return (id_format == "UUID7") ? EventIdFormat::UUID7 : EventIdFormat::UUID4;
+        }
+        std::cerr << "EVENT_ID_FORMAT is set to an invalid value. Defaulting to UUID4." << std::endl;
+    }
+
+    return EventIdFormat::UUID4;
+}
@@ -0,0 +1,73 @@
+#include <error_resolution_diagnoser/event_record.h>
+#include <mutex>
+#include <unordered_map>
+
+// Module and source names of a classification table are few, the cap only guards against a table that is not
+static const size_t MAX_INTERNED_STRINGS = 1024;
+
+static const std::shared_ptr<const std::string> &null_string()
+{
+    static const std::shared_ptr<const std::string> null_str = std::make_shared<const std::string>("Null");
+    return null_str;
+}
+
+std::shared_ptr<const std::string> intern_string(const std::string &text)
+{
+    static std::mutex intern_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const std::string>> interned;
+
+    std::lock_guard<std::mutex> lock(intern_mutex);
+    auto found = interned.find(text);
+    if (found != interned.end())
+    {
+        return found->second;
+    }
+
+    // Once the table is full, new names get their own copy instead of growing it
+    std::shared_ptr<const std::string> shared = std::make_shared<const std::string>(text);
+    if (interned.size() < MAX_INTERNED_STRINGS)
+    {
+        interned.emplace(text, shared);
+    }
+    return shared;
+}
+
+EventRecord::EventRecord()
+{
+    // Defaults of an unclassified record
+    this->level = EventLevel::ERROR;
+    this->compounding = Compounding::UNSET;
+    this->module = null_string();
+    this->source = null_string();
+    this->description = "Null";
+    this->resolution = "Null";
+}
+
+bool EventRecord::creates_ticket() const
+{
+    return ((this->level == EventLevel::ERROR) || (this->level == EventLevel::FATAL)) && (this->compounding != Compounding::YES);
+}
+
+std::string EventRecord::time_str() const
+{
+    return TimestampFormatter::local().iso_string(this->time);
+}
+
+std::string EventRecord::level_str() const
+{
+    return std::to_string(static_cast<int>(this->level));
+}
+
+std::string EventRecord::compounding_str() const
+{
+    if (this->compounding == Compounding::YES)
+    {
+        return "true";
+    }
+    else if (this->compounding == Compounding::NO)
+    {
+        return "false";
+    }
+
+    return "Null";
+}
@@ -0,0 +1,219 @@
+#include <error_resolution_diagnoser/http_client_pool.h>
+#include <stdexcept>
+
+using namespace web::http::client; // HTTP client features
+
+HttpClientPool::HttpClientPool(std::string host, http_client_config config, size_t max_clients, std::chrono::milliseconds idle_timeout)
+{
+    this->host = host;
+    this->config = config;
+    this->max_clients = (max_clients > 0) ? max_clients : 1;
+    this->idle_timeout = idle_timeout;
+    this->open_clients = 0;
+    this->created = 0;
+    this->discarded = 0;
+    this->generation = 0;
+}
+
+HttpClientPool::~HttpClientPool()
+{
+    // Callers still waiting will never get a client, fail them instead of leaving their tasks pending
+    std::deque<pplx::task_completion_event<std::shared_ptr<Lease>>> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(this->pool_mutex);
+        abandoned.swap(this->waiters);
+    }
+    for (auto &waiter : abandoned)
+    {
+        waiter.set_exception(std::runtime_error("HTTP client pool closed"));
+    }
+}
+
+void HttpClientPool::reap_locked(std::chrono::steady_clock::time_point now)
+{
+    // Idle clients are ordered by last use, so the stale ones are at the front
+    size_t stale = 0;
+    while ((stale < this->idle.size()) && ((now - this->idle[stale].last_used) > this->idle_timeout))
+    {
+        stale++;
+    }
+
+    if (stale > 0)
+    {
+        this->idle.erase(this->idle.begin(), this->idle.begin() + stale);
+        this->open_clients -= stale;
+        this->pool_cv.notify_all();
+    }
+}
+
+bool HttpClientPool::take_locked(PooledClient &entry)
+{
+    if (!(this->idle.empty()))
+    {
+        // Most recently used client is the most likely to still have a live connection
+        entry = std::move(this->idle.back());
+        this->idle.pop_back();
+        return true;
+    }
+    if (this->open_clients < this->max_clients)
+    {
+        entry.client.reset(new http_client(this->host, this->config));
+        entry.generation = this->generation;
+        this->open_clients++;
+        this->created++;
+        return true;
+    }
+
+    return false;
+}
+
+void HttpClientPool::serve_waiters_locked(ReadyWaiters &ready)
+{
+    PooledClient entry;
+    while (!(this->waiters.empty()) && this->take_locked(entry))
+    {
+        ready.emplace_back(this->waiters.front(), std::make_shared<Lease>(this, std::move(entry)));
+        this->waiters.pop_front();
+    }
+}
+
+void HttpClientPool::complete(ReadyWaiters &ready)
+{
+    // Continuations may run inline and return their lease right away, so the pool lock must not be held
+    for (auto &waiter : ready)
+    {
+        waiter.first.set(waiter.second);
+    }
+    ready.clear();
+}
+
+std::shared_ptr<HttpClientPool::Lease> HttpClientPool::acquire()
+{
+    std::unique_lock<std::mutex> lock(this->pool_mutex);
+    this->reap_locked(std::chrono::steady_clock::now());
+
+    // Wait for a client to come back if every allowed client is in use. Asynchronous callers already waiting go first.
+    PooledClient entry;
+    this->pool_cv.wait(lock, [this] { return this->waiters.empty() && (!(this->idle.empty()) || (this->open_clients < this->max_clients)); });
+    this->take_locked(entry);
+
+    return std::make_shared<Lease>(this, std::move(entry));
+}
+
+pplx::task<std::shared_ptr<HttpClientPool::Lease>> HttpClientPool::acquire_async()
+{
+    std::lock_guard<std::mutex> lock(this->pool_mutex);
+    this->reap_locked(std::chrono::steady_clock::now());
+
+    PooledClient entry;
+    if (this->waiters.empty() && this->take_locked(entry))
+    {
+        return pplx::task_from_result(std::make_shared<Lease>(this, std::move(entry)));
+    }
+
+    // Pool exhausted, complete once a client comes back instead of holding a thread until then
+    pplx::task_completion_event<std::shared_ptr<Lease>> waiter;
+    this->waiters.push_back(waiter);
+    return pplx::create_task(waiter);
+}
+
+void HttpClientPool::reap_idle()
+{
+    std::lock_guard<std::mutex> lock(this->pool_mutex);
+    this->reap_locked(std::chrono::steady_clock::now());
+}
+
+void HttpClientPool::set_timeout(std::chrono::milliseconds timeout)
+{
+    std::lock_guard<std::mutex> lock(this->pool_mutex);
+    if (this->config.timeout<std::chrono::milliseconds>() == timeout)
+    {
+        return;
+    }
+
+    // Idle clients have the old timeout baked in, clients in use are dropped when they come back
+    this->config.set_timeout(timeout);
+    this->generation++;
+    this->open_clients -= this->idle.size();
+    this->idle.clear();
+    this->pool_cv.notify_all();
+}
+
+std::chrono::milliseconds HttpClientPool::get_timeout()
+{
+    std::lock_guard<std::mutex> lock(this->pool_mutex);
+    return this->config.timeout<std::chrono::milliseconds>();
+}
+
+size_t HttpClientPool::idle_count()
+{
+    std::lock_guard<std::mutex> lock(this->pool_mutex);
+    return this->idle.size();
+}
+
+size_t HttpClientPool::open_count()
+{
+    std::lock_guard<std::mutex> lock(this->pool_mutex);
+    return this->open_clients;
+}
+
+uint64_t HttpClientPool::created_count()
+{
+    std::lock_guard<std::mutex> lock(this->pool_mutex);
+    return this->created;
+}
+
+uint64_t HttpClientPool::discarded_count()
+{
+    std::lock_guard<std::mutex> lock(this->pool_mutex);
+    return this->discarded;
+}
+
+HttpClientPool::Lease::Lease(HttpClientPool *pool, PooledClient entry)
+{
+    this->pool = pool;
+    this->entry = std::move(entry);
+    this->healthy = true;
+}
+
+HttpClientPool::Lease::~Lease()
+{
+    ReadyWaiters ready;
+    {
+        std::lock_guard<std::mutex> lock(this->pool->pool_mutex);
+
+        if (this->healthy && (this->entry.generation == this->pool->generation))
+        {
+            // Back to the pool for the next query
+            this->entry.last_used = std::chrono::steady_clock::now();
+            this->pool->idle.push_back(std::move(this->entry));
+        }
+        else if (this->healthy)
+        {
+            // Configuration changed while in use, let the next query start a client with the new one
+            this->pool->open_clients--;
+        }
+        else
+        {
+            // Connection may be half open, let the next query start a fresh client
+            this->pool->open_clients--;
+            this->pool->discarded++;
+        }
+
+        // Waiting asynchronous callers take the client first
+        this->pool->serve_waiters_locked(ready);
+        this->pool->pool_cv.notify_one();
+    }
+
+    complete(ready);
+}
+
+http_client &HttpClientPool::Lease::client()
+{
+    return *(this->entry.client);
+}
+
+void HttpClientPool::Lease::discard()
+{
+    this->healthy = false;
+}
@@ -0,0 +1,145 @@
+#include <error_resolution_diagnoser/json_writer.h>
+#include <cstdio>
+
+JsonWriter::JsonWriter()
+{
+    this->need_comma = false;
+}
+
+void JsonWriter::separate()
+{
+    if (this->need_comma)
+    {
+        this->buffer.push_back(',');
+    }
+}
+
+void JsonWriter::clear()
+{
+    this->buffer.clear();
+    this->need_comma = false;
+}
+
+void JsonWriter::begin_object()
+{
+    this->separate();
+    this->buffer.push_back('{');
+    this->need_comma = false;
+}
+
+void JsonWriter::end_object()
+{
+    this->buffer.push_back('}');
+    this->need_comma = true;
+}
+
+void JsonWriter::string(const std::string &text)
+{
+    this->string(text.data(), text.size());
+}
+
+void JsonWriter::string(const char *data, size_t len)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    this->separate();
+    this->buffer.push_back('"');
+
+    // Copy runs of plain characters in one go, escape the same characters cpprest does
+    size_t start = 0;
+    for (size_t idx = 0; idx < len; idx++)
+    {
+        unsigned char ch = static_cast<unsigned char>(data[idx]);
+        if ((ch >= 0x20) && (ch != '"') && (ch != '\\'))
+        {
+            continue;
+        }
+
+        this->buffer.append(data + start, idx - start);
+        start = idx + 1;
+
+        switch (ch)
+        {
+        case '"':
+            this->buffer.append("\\\"", 2);
+            break;
+        case '\\':
+            this->buffer.append("\\\\", 2);
+            break;
+        case '\b':
+            this->buffer.append("\\b", 2);
+            break;
+        case '\f':
+            this->buffer.append("\\f", 2);
+            break;
+        case '\n':
+            this->buffer.append("\\n", 2);
+            break;
+        case '\r':
+            this->buffer.append("\\r", 2);
+            break;
+        case '\t':
+            this->buffer.append("\\t", 2);
+            break;
+        default:
+            // Other control characters are written as unicode escapes
+            char escaped[6] = {'\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0x0F]};
+            this->buffer.append(escaped, sizeof(escaped));
+            break;
+        }
+    }
+    this->buffer.append(data + start, len - start);
+
+    this->buffer.push_back('"');
+    this->need_comma = true;
+}
+
+void JsonWriter::boolean(bool flag)
+{
+    this->separate();
+    if (flag)
+    {
+        this->buffer.append("true", 4);
+    }
+    else
+    {
+        this->buffer.append("false", 5);
+    }
+    this->need_comma = true;
+}
+
+void JsonWriter::number(double value)
+{
+    // Same format as cpprest so consumers see the same digits
+    char text[32];
+    int len = snprintf(text, sizeof(text), "%.17g", value);
+
+    this->separate();
+    this->buffer.append(text, len);
+    this->need_comma = true;
+}
+
+void JsonWriter::null()
+{
+    this->separate();
+    this->buffer.append("null", 4);
+    this->need_comma = true;
+}
+
+void JsonWriter::raw(const std::string &serialized)
+{
+    this->separate();
+    this->buffer.append(serialized);
+    this->need_comma = true;
+}
+
+const std::string &JsonWriter::str() const
+{
+    return this->buffer;
+}
+
+JsonWriter &JsonWriter::local()
+{
+    thread_local JsonWriter writer;
+    return writer;
+}
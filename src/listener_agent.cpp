@@ -23,16 +23,17 @@ cs_listener::cs_listener()
     // See if configuration is correct otherwise default to ROS
     if ((this->agent_type == "DB") || (this->agent_type == "ERT") || (this->agent_type == "ECS"))
     {
-      if (std::getenv("ECS_API"))
+      if (std::getenv("ECS_API") || std::getenv("ECS_TABLE_FILE"))
       {
         // Success case
-        if (std::getenv("ECS_ROBOT_MODEL"))
+        if (!std::getenv("ECS_ROBOT_MODEL"))
         {
-          // Success case
+          // Failure case - Default
+          this->agent_type = "ROS";
         }
-        else
+        else if (this->state_manager_instance.get_agent_type() == "ROS")
         {
-          // Failure case - Default
+          // Failure case - Default, the back end API found nothing to classify with
           this->agent_type = "ROS";
         }
       }
@@ -42,6 +43,21 @@ cs_listener::cs_listener()
         this->agent_type = "ROS";
       }
     }
+    else if (this->agent_type == "RULES")
+    {
+      if (!std::getenv("RULES_FILE"))
+      {
+        // Failure case - Default
+        std::cerr << "Agent configured in RULES mode but RULES_FILE is not configured. Defaulting back to ROS mode instead..." << std::endl;
+        this->agent_type = "ROS";
+      }
+      else if (this->state_manager_instance.get_rule_count() == 0)
+      {
+        // Failure case - Default
+        std::cerr << "Agent configured in RULES mode but no rules loaded from RULES_FILE. Defaulting back to ROS mode instead..." << std::endl;
+        this->agent_type = "ROS";
+      }
+    }
   }
   else
   {
@@ -93,87 +109,98 @@ cs_listener::cs_listener()
   // Heartbeat parameters
   this->heartrate = ros::WallDuration(15.0);
 
-  // Telemetry
-  // Create JSON object
-  this->telemetry = json::value::object();
-
   // Diagnostics
   this->num_diag_samples = 0;
   this->curr_diag_sample = INT_MIN;
+
+  // Log queue size
+  size_t log_queue_size = 1024;
+  if (std::getenv("LOG_QUEUE_SIZE"))
+  {
+    try
+    {
+      // Success case
+      log_queue_size = std::stoul(std::getenv("LOG_QUEUE_SIZE"));
+      std::cout << "LOG_QUEUE_SIZE: " << log_queue_size << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+      // Failure case - Default
+      std::cerr << "LOG_QUEUE_SIZE is set to an invalid value. Defaulting to " << log_queue_size << "." << std::endl;
+    }
+  }
+
+  // Classification lookups in flight
+  this->max_in_flight = 16;
+  if (std::getenv("ECS_MAX_IN_FLIGHT"))
+  {
+    try
+    {
+      // Success case
+      size_t max_in_flight = std::stoul(std::getenv("ECS_MAX_IN_FLIGHT"));
+      if (max_in_flight == 0)
+      {
+        throw std::invalid_argument("ECS_MAX_IN_FLIGHT");
+      }
+      this->max_in_flight = max_in_flight;
+      std::cout << "ECS_MAX_IN_FLIGHT: " << this->max_in_flight << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+      // Failure case - Default
+      std::cerr << "ECS_MAX_IN_FLIGHT is set to an invalid value. Defaulting to " << this->max_in_flight << "." << std::endl;
+    }
+  }
+
+  // Start log worker. log_callback only enqueues, state management runs on this thread.
+  this->log_queue.reset(new SpscRing<rosgraph_msgs::Log::ConstPtr>(log_queue_size));
+  this->log_worker_running = true;
+  this->log_worker_signaled = false;
+  this->log_worker = std::thread(&cs_listener::log_worker_loop, this);
 }
 
 cs_listener::~cs_listener()
 {
+  // Stop spinners so no callback runs during shutdown
+  this->stop_spinners();
+  // Stop log worker
+  this->log_worker_stop();
   // Stop heartbeat
   this->heartbeat_stop();
   // Destructor
   std::cout << "error_resolution_diagnoser stopped..." << std::endl;
 }
 
-json::value cs_listener::odom_to_json(const nav_msgs::Odometry::ConstPtr &rosmsg)
+PoseState cs_listener::odom_to_state(const nav_msgs::Odometry::ConstPtr &rosmsg)
 {
-  // Create JSON objects
-  json::value odom_json = json::value::object();
-  json::value orientation = json::value::object();
-  json::value position = json::value::object();
-
-  // Create keys
-  utility::string_t oKey(utility::conversions::to_string_t("orientation"));
-  utility::string_t pKey(utility::conversions::to_string_t("position"));
-  utility::string_t wKey(utility::conversions::to_string_t("w"));
-  utility::string_t xKey(utility::conversions::to_string_t("x"));
-  utility::string_t yKey(utility::conversions::to_string_t("y"));
-  utility::string_t zKey(utility::conversions::to_string_t("z"));
-
-  // Assign orientation key-value
-  orientation[wKey] = json::value::number(rosmsg->pose.pose.orientation.w);
-  orientation[xKey] = json::value::number(rosmsg->pose.pose.orientation.x);
-  orientation[yKey] = json::value::number(rosmsg->pose.pose.orientation.y);
-  orientation[zKey] = json::value::number(rosmsg->pose.pose.orientation.z);
-
-  // Assign position key-value
-  position[xKey] = json::value::number(rosmsg->pose.pose.position.x);
-  position[yKey] = json::value::number(rosmsg->pose.pose.position.y);
-  position[zKey] = json::value::number(rosmsg->pose.pose.position.z);
-
-  // Assign odom key-value
-  odom_json[oKey] = orientation;
-  odom_json[pKey] = position;
-
-  return (odom_json);
+  // Copy pose into a plain struct, JSON is only built when an event is pushed
+  PoseState odom_state;
+  odom_state.valid = true;
+  odom_state.position_x = rosmsg->pose.pose.position.x;
+  odom_state.position_y = rosmsg->pose.pose.position.y;
+  odom_state.position_z = rosmsg->pose.pose.position.z;
+  odom_state.orientation_w = rosmsg->pose.pose.orientation.w;
+  odom_state.orientation_x = rosmsg->pose.pose.orientation.x;
+  odom_state.orientation_y = rosmsg->pose.pose.orientation.y;
+  odom_state.orientation_z = rosmsg->pose.pose.orientation.z;
+
+  return (odom_state);
 }
 
-json::value cs_listener::pose_to_json(const geometry_msgs::PoseWithCovarianceStamped::ConstPtr &rosmsg)
+PoseState cs_listener::pose_to_state(const geometry_msgs::PoseWithCovarianceStamped::ConstPtr &rosmsg)
 {
-  // Create JSON objects
-  json::value pose_json = json::value::object();
-  json::value orientation = json::value::object();
-  json::value position = json::value::object();
-
-  // Create keys
-  utility::string_t oKey(utility::conversions::to_string_t("orientation"));
-  utility::string_t pKey(utility::conversions::to_string_t("position"));
-  utility::string_t wKey(utility::conversions::to_string_t("w"));
-  utility::string_t xKey(utility::conversions::to_string_t("x"));
-  utility::string_t yKey(utility::conversions::to_string_t("y"));
-  utility::string_t zKey(utility::conversions::to_string_t("z"));
-
-  // Assign orientation key-value
-  orientation[wKey] = json::value::number(rosmsg->pose.pose.orientation.w);
-  orientation[xKey] = json::value::number(rosmsg->pose.pose.orientation.x);
-  orientation[yKey] = json::value::number(rosmsg->pose.pose.orientation.y);
-  orientation[zKey] = json::value::number(rosmsg->pose.pose.orientation.z);
-
-  // Assign position key-value
-  position[xKey] = json::value::number(rosmsg->pose.pose.position.x);
-  position[yKey] = json::value::number(rosmsg->pose.pose.position.y);
-  position[zKey] = json::value::number(rosmsg->pose.pose.position.z);
-
-  // Assign odom key-value
-  pose_json[oKey] = orientation;
-  pose_json[pKey] = position;
-
-  return (pose_json);
+  // Copy pose into a plain struct, JSON is only built when an event is pushed
+  PoseState pose_state;
+  pose_state.valid = true;
+  pose_state.position_x = rosmsg->pose.pose.position.x;
+  pose_state.position_y = rosmsg->pose.pose.position.y;
+  pose_state.position_z = rosmsg->pose.pose.position.z;
+  pose_state.orientation_w = rosmsg->pose.pose.orientation.w;
+  pose_state.orientation_x = rosmsg->pose.pose.orientation.x;
+  pose_state.orientation_y = rosmsg->pose.pose.orientation.y;
+  pose_state.orientation_z = rosmsg->pose.pose.orientation.z;
+
+  return (pose_state);
 }
 
 void cs_listener::setup_telemetry(ros::NodeHandle nh)
@@ -184,10 +211,10 @@ void cs_listener::setup_telemetry(ros::NodeHandle nh)
   std::string pose_topic = "amcl_pose";
 
   this->odom_sub =
-      nh.subscribe(odom_topic, 1000, &cs_listener::odom_callback, this);
+      this->queue_handle(nh, &(this->odom_cb_queue)).subscribe(odom_topic, 1000, &cs_listener::odom_callback, this);
 
   this->pose_sub =
-      nh.subscribe(pose_topic, 1000, &cs_listener::pose_callback, this);
+      this->queue_handle(nh, &(this->pose_cb_queue)).subscribe(pose_topic, 1000, &cs_listener::pose_callback, this);
 
   // // Example for optional subscription
   // const ros::master::TopicInfo &info = *it;
@@ -215,64 +242,256 @@ void cs_listener::setup_diagnostics(ros::NodeHandle nh)
   {
     // Subscribe to diagnostics_agg topic
     this->diag_sub =
-        nh.subscribe("diagnostics_agg", 1000, &cs_listener::diag_callback, this);
+        this->queue_handle(nh, &(this->diag_cb_queue)).subscribe("diagnostics_agg", 1000, &cs_listener::diag_callback, this);
+  }
+}
+
+void cs_listener::setup_log(ros::NodeHandle nh)
+{
+  // Subscribe to rosout_agg topic
+  this->log_sub =
+      this->queue_handle(nh, &(this->log_cb_queue)).subscribe("rosout_agg", 1000, &cs_listener::log_callback, this);
+}
+
+ros::NodeHandle cs_listener::queue_handle(ros::NodeHandle nh, ros::CallbackQueue *queue)
+{
+  // Copy of the node handle that puts its callbacks on the given queue
+  ros::NodeHandle queue_nh(nh);
+  queue_nh.setCallbackQueue(queue);
+  return queue_nh;
+}
+
+void cs_listener::start_spinners()
+{
+  // One thread per queue, so a slow callback only ever delays its own subscriber.
+  // The rosout queue must stay single threaded since log_callback is the only producer of the log ring.
+  ros::CallbackQueue *queues[] = {&(this->log_cb_queue), &(this->odom_cb_queue), &(this->pose_cb_queue),
+                                  &(this->diag_cb_queue), &(this->heartbeat_cb_queue)};
+
+  for (ros::CallbackQueue *queue : queues)
+  {
+    this->spinners.emplace_back(new ros::AsyncSpinner(1, queue));
+    this->spinners.back()->start();
+  }
+}
+
+void cs_listener::stop_spinners()
+{
+  for (auto &spinner : this->spinners)
+  {
+    spinner->stop();
   }
+  this->spinners.clear();
 }
 
 void cs_listener::log_callback(const rosgraph_msgs::Log::ConstPtr &rosmsg)
 {
+  // Decide whether this message is processed at all
+  bool accept = false;
+
   // If node list is not set
   if (this->node_list.empty())
   {
     // If node except list is not set, process everything
     if (this->node_ex_list.empty())
     {
-      // To debug this callback function
-      std::cout << "Message received: " << rosmsg->msg << std::endl;
-
-      // Callback that hands over message to State Manager
-      this->state_manager_instance.check_message(this->agent_type, this->robot_code, rosmsg, this->telemetry);
+      accept = true;
     }
     else
     {
       // If incoming message is NOT from the node except list, process
-      if (find(this->node_ex_list.begin(), this->node_ex_list.end(), rosmsg->name) == this->node_ex_list.end())
-      {
-        // To debug this callback function
-        std::cout << "Message received: " << rosmsg->msg << std::endl;
-
-        // Callback that hands over message to State Manager
-        this->state_manager_instance.check_message(this->agent_type, this->robot_code, rosmsg, this->telemetry);
-      }
+      accept = (find(this->node_ex_list.begin(), this->node_ex_list.end(), rosmsg->name) == this->node_ex_list.end());
     }
   }
   else
   {
     // If incoming message IS from the node list, process
-    if (find(this->node_list.begin(), this->node_list.end(), rosmsg->name) != this->node_list.end())
+    accept = (find(this->node_list.begin(), this->node_list.end(), rosmsg->name) != this->node_list.end());
+  }
+
+  // Hand the message pointer over to the log worker. If the queue is full the message is dropped and counted.
+  if (accept && this->log_queue->push(rosmsg))
+  {
+    this->log_worker_signal();
+  }
+}
+
+void cs_listener::log_worker_loop()
+{
+  rosgraph_msgs::Log::ConstPtr rosmsg;
+
+  while (true)
+  {
+    // Hand over messages whose classification arrived, oldest first
+    this->complete_pending_logs(false);
+
+    // Take the next message unless too many lookups are in flight already
+    if ((this->pending_logs.size() < this->max_in_flight) && this->log_queue->pop(rosmsg))
+    {
+      this->process_log(rosmsg);
+      continue;
+    }
+
+    // Queue is empty, exit if stopped and nothing is in flight
+    if (!this->log_worker_running && this->pending_logs.empty())
+    {
+      break;
+    }
+
+    if ((this->pending_logs.size() >= this->max_in_flight) || !this->log_worker_running)
     {
-      // To debug this callback function
-      std::cout << "Message received: " << rosmsg->msg << std::endl;
+      // At the limit or draining, nothing more can start before the oldest lookup is done
+      this->complete_pending_logs(true);
+    }
+    else
+    {
+      // Otherwise sleep until the next message or a finished lookup. Signals raised since the last wait
+      // are kept in the flag, so one arriving between the checks above and the wait is not lost.
+      std::unique_lock<std::mutex> lock(this->log_worker_mutex);
+      this->log_worker_cv.wait(lock, [this]() { return this->log_worker_signaled; });
+      this->log_worker_signaled = false;
+    }
+  }
+}
+
+void cs_listener::process_log(const rosgraph_msgs::Log::ConstPtr &rosmsg)
+{
+  // To debug this callback function. Only formatted at DEBUG level, so ingest does not write and flush stdout per message.
+  ROS_DEBUG_STREAM("Message received: " << rosmsg->msg);
+
+  Telemetry telemetry = this->get_telemetry();
+
+  // ROS messages and local rules need no lookup, hands over message to State Manager
+  if ((this->agent_type == "ROS") || (this->agent_type == "RULES"))
+  {
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    this->state_manager_instance.check_message(this->agent_type, this->robot_code, rosmsg, telemetry);
+    return;
+  }
+
+  // Start the lookup without holding the state, the worker is woken up once the answer arrives
+  PendingLog pending;
+  pending.rosmsg = rosmsg;
+  pending.telemetry = telemetry;
+  pending.classification = this->state_manager_instance.classify_message(rosmsg->msg).then([this](json::value msg_info) {
+    this->log_worker_signal();
+    return msg_info;
+  });
+  this->pending_logs.push_back(std::move(pending));
+}
+
+void cs_listener::complete_pending_logs(bool wait_oldest)
+{
+  if (wait_oldest && !(this->pending_logs.empty()))
+  {
+    this->pending_logs.front().classification.wait();
+  }
+
+  // Stop at the first lookup still in flight so state management sees messages in the order they arrived
+  while (!(this->pending_logs.empty()) && this->pending_logs.front().classification.is_done())
+  {
+    PendingLog &pending = this->pending_logs.front();
+    json::value msg_info = json::value::null();
+    try
+    {
+      msg_info = pending.classification.get();
+    }
+    catch (const std::exception &e)
+    {
+      // Lookup failed, handled like a message that is not in the table
+      std::cerr << "Classification failed: " << e.what() << std::endl;
+    }
 
-      // Callback that hands over message to State Manager
-      this->state_manager_instance.check_message(this->agent_type, this->robot_code, rosmsg, this->telemetry);
+    {
+      // Hands over message to State Manager
+      std::lock_guard<std::mutex> lock(this->state_mutex);
+      this->state_manager_instance.check_message(this->agent_type, this->robot_code, pending.rosmsg, pending.telemetry, msg_info);
     }
+    this->pending_logs.pop_front();
+  }
+}
+
+void cs_listener::log_worker_stop()
+{
+  // Let the worker drain the queue and the lookups in flight, then exit
+  if (this->log_worker.joinable())
+  {
+    this->log_worker_running = false;
+    this->log_worker_signal();
+    this->log_worker.join();
   }
 }
 
+void cs_listener::log_worker_signal()
+{
+  // Set the flag under the mutex, so the worker cannot miss it between checking for work and waiting
+  {
+    std::lock_guard<std::mutex> lock(this->log_worker_mutex);
+    this->log_worker_signaled = true;
+  }
+  this->log_worker_cv.notify_one();
+}
+
+size_t cs_listener::get_log_queue_depth()
+{
+  return this->log_queue->depth();
+}
+
+uint64_t cs_listener::get_log_queue_overflows()
+{
+  return this->log_queue->overflow_count();
+}
+
+ClassificationStats cs_listener::get_classification_stats()
+{
+  // Cache counters are guarded by the cache itself, no need to hold state_mutex
+  return this->state_manager_instance.get_classification_stats();
+}
+
+bool cs_listener::save_classification_cache()
+{
+  // Cache is guarded by itself, no need to hold state_mutex
+  return this->state_manager_instance.save_classification_cache();
+}
+
+StateUsage cs_listener::get_msg_usage()
+{
+  // Suppression tables are shared with the log worker
+  std::lock_guard<std::mutex> lock(this->state_mutex);
+  return this->state_manager_instance.get_msg_usage();
+}
+
+StateUsage cs_listener::get_diag_usage()
+{
+  std::lock_guard<std::mutex> lock(this->state_mutex);
+  return this->state_manager_instance.get_diag_usage();
+}
+
+StateUsage cs_listener::get_template_usage()
+{
+  // Template miner is guarded by its own mutex, no need to hold state_mutex
+  return this->state_manager_instance.get_template_usage();
+}
+
+BreakerStats cs_listener::get_ecs_breaker_stats()
+{
+  // Breaker is guarded by itself, no need to hold state_mutex
+  return this->state_manager_instance.get_ecs_breaker_stats();
+}
+
+Telemetry cs_listener::get_telemetry()
+{
+  // Consistent snapshot of the latest poses, never blocks the writers
+  return Telemetry(this->telemetry.snapshot(), &(this->telemetry));
+}
+
 void cs_listener::odom_callback(const nav_msgs::Odometry::ConstPtr &rosmsg)
 {
   // Process odometry information for telemetry
   // std::cout << "Odom callback called" << std::endl;
 
-  // Convert to JSON
-  json::value odom_data = this->odom_to_json(rosmsg);
-
-  // Create key
-  utility::string_t odomKey(utility::conversions::to_string_t("odom_pose"));
-
-  // Assign key-value
-  this->telemetry[odomKey] = odom_data;
+  // Record pose, no allocation or locking
+  this->telemetry.set_odom_pose(this->odom_to_state(rosmsg));
 }
 
 void cs_listener::pose_callback(const geometry_msgs::PoseWithCovarianceStamped::ConstPtr &rosmsg)
@@ -280,14 +499,8 @@ void cs_listener::pose_callback(const geometry_msgs::PoseWithCovarianceStamped::
   // Process pose information for telemetry
   // std::cout << "Pose callback called" << std::endl;
 
-  // Convert to JSON
-  json::value pose_data = this->pose_to_json(rosmsg);
-
-  // Create key
-  utility::string_t poseKey(utility::conversions::to_string_t("nav_pose"));
-
-  // Assign key-value
-  this->telemetry[poseKey] = pose_data;
+  // Record pose, no allocation or locking
+  this->telemetry.set_nav_pose(this->pose_to_state(rosmsg));
 }
 
 void cs_listener::diag_callback(const diagnostic_msgs::DiagnosticArray::ConstPtr &rosmsg)
@@ -301,7 +514,9 @@ void cs_listener::diag_callback(const diagnostic_msgs::DiagnosticArray::ConstPtr
     // Handle special case of if the current sample index is INT_MIN then it is the first ever sample, so we process.
     if (this->curr_diag_sample == INT_MIN)
     {
-      this->state_manager_instance.check_diagnostic(this->agent_type, this->robot_code, rosmsg->status, this->telemetry);
+      Telemetry telemetry = this->get_telemetry();
+      std::lock_guard<std::mutex> lock(this->state_mutex);
+      this->state_manager_instance.check_diagnostic(this->agent_type, this->robot_code, rosmsg->status, telemetry);
       this->curr_diag_sample = 0;
     }
     else
@@ -314,7 +529,9 @@ void cs_listener::diag_callback(const diagnostic_msgs::DiagnosticArray::ConstPtr
   else
   {
     // General case to process current sample if index > prescribed number
-    this->state_manager_instance.check_diagnostic(this->agent_type, this->robot_code, rosmsg->status, this->telemetry);
+    Telemetry telemetry = this->get_telemetry();
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    this->state_manager_instance.check_diagnostic(this->agent_type, this->robot_code, rosmsg->status, telemetry);
     // Reset index back to 0 to restart sampling loop again
     this->curr_diag_sample = 0;
   }
@@ -323,23 +540,31 @@ void cs_listener::diag_callback(const diagnostic_msgs::DiagnosticArray::ConstPtr
 void cs_listener::heartbeat_start(ros::NodeHandle nh)
 {
   // Records heartbeat online status when node is started. Future status is pushed by timer bound callback
-  this->state_manager_instance.check_heartbeat(true, this->telemetry);
+  {
+    Telemetry telemetry = this->get_telemetry();
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    this->state_manager_instance.check_heartbeat(true, telemetry);
+  }
 
   // Create a Wall Timer for heartrate period
-  this->heartbeat_timer = nh.createWallTimer(this->heartrate, &cs_listener::heartbeat_log, this);
+  this->heartbeat_timer = this->queue_handle(nh, &(this->heartbeat_cb_queue)).createWallTimer(this->heartrate, &cs_listener::heartbeat_log, this);
 }
 
 void cs_listener::heartbeat_log(const ros::WallTimerEvent &timer_event)
 {
   // A timer bound method that periodically checks the ROS connection status and passes it to the state manager.
   bool status = ros::master::check();
-  this->state_manager_instance.check_heartbeat(status, this->telemetry);
+  Telemetry telemetry = this->get_telemetry();
+  std::lock_guard<std::mutex> lock(this->state_mutex);
+  this->state_manager_instance.check_heartbeat(status, telemetry);
 }
 
 void cs_listener::heartbeat_stop()
 {
   // Records heartbeat offline status when node is shutdown
-  this->state_manager_instance.check_heartbeat(false, this->telemetry);
+  Telemetry telemetry = this->get_telemetry();
+  std::lock_guard<std::mutex> lock(this->state_mutex);
+  this->state_manager_instance.check_heartbeat(false, telemetry);
 }
 
 int main(int argc, char **argv)
@@ -348,7 +573,6 @@ int main(int argc, char **argv)
   // Initialize node
   ros::init(argc, argv, "error_resolution_diagnoser");
   ros::NodeHandle nh;
-  ros::Rate looprate(10);
 
   // Create Agent
   cs_listener cs_agent;
@@ -363,22 +587,23 @@ int main(int argc, char **argv)
   cs_agent.setup_diagnostics(nh);
 
   // Create /rosout_agg subscriber
-  ros::Subscriber rosout_agg_sub =
-      nh.subscribe("rosout_agg", 1000, &cs_listener::log_callback, &cs_agent);
+  cs_agent.setup_log(nh);
+
+  // Service every subscriber and the heartbeat on their own threads
+  cs_agent.start_spinners();
 
   // ROS Master reconnection parameters
   RobotStatus status = RobotStatus::RUNNING;
   std::string session_id;
   nh.param<std::string>("/run_id", session_id, "unknown");
-  int loop_counter;
+  int loop_counter = 0;
   std::cout << "AGENT:: STATUS:: OK" << std::endl;
 
-  while (ros::ok())
-  {
-    ros::spinOnce();
-    looprate.sleep();
-
-    // ROS Master Connection/Reconnection
+  // ROS Master Connection/Reconnection is checked on its own queue and thread
+  ros::CallbackQueue master_cb_queue;
+  ros::NodeHandle master_nh(nh);
+  master_nh.setCallbackQueue(&master_cb_queue);
+  ros::WallTimer master_timer = master_nh.createWallTimer(ros::WallDuration(1.0), [&](const ros::WallTimerEvent &) {
     bool master_status = ros::master::check();
     if (!master_status && status == RobotStatus::RUNNING)
     {
@@ -399,7 +624,8 @@ int main(int argc, char **argv)
         // If ROS master is new, restart agent.
         std::cout << "AGENT:: New ROS master detected. Restarting agent." << std::endl;
         std::cout << "AGENT:: STATUS:: OFFLINE" << std::endl;
-        break;
+        ros::requestShutdown();
+        return;
       }
     }
     else if (!master_status && status == RobotStatus::MASTER_DISCONNECTED)
@@ -412,7 +638,8 @@ int main(int argc, char **argv)
       status = RobotStatus::RUNNING;
     }
 
-    if (loop_counter % 6000 == 0)
+    // Periodic status, every 10 minutes
+    if (loop_counter % 600 == 0)
     {
       if (status == RobotStatus::RUNNING)
       {
@@ -422,8 +649,41 @@ int main(int argc, char **argv)
       {
         std::cout << "AGENT:: STATUS:: MASTER_DISCONNECTED" << std::endl;
       }
+      std::cout << "AGENT:: LOG QUEUE:: depth " << cs_agent.get_log_queue_depth()
+                << ", dropped " << cs_agent.get_log_queue_overflows() << std::endl;
+      ClassificationStats ecs_stats = cs_agent.get_classification_stats();
+      if ((ecs_stats.hits + ecs_stats.negative + ecs_stats.misses) > 0)
+      {
+        std::cout << "AGENT:: ECS CACHE:: entries " << ecs_stats.entries << ", hits " << ecs_stats.hits
+                  << ", negative hits " << ecs_stats.negative << ", misses " << ecs_stats.misses
+                  << ", coalesced " << ecs_stats.coalesced << std::endl;
+      }
+      StateUsage msg_usage = cs_agent.get_msg_usage();
+      StateUsage diag_usage = cs_agent.get_diag_usage();
+      StateUsage template_usage = cs_agent.get_template_usage();
+      std::cout << "AGENT:: STATE:: messages " << msg_usage.entries << " (" << msg_usage.bytes << " bytes, evicted " << msg_usage.evictions
+                << "), diagnostics " << diag_usage.entries << " (" << diag_usage.bytes << " bytes, evicted " << diag_usage.evictions
+                << "), templates " << template_usage.entries << " (" << template_usage.bytes << " bytes, evicted " << template_usage.evictions
+                << ")" << std::endl;
+      BreakerStats breaker_stats = cs_agent.get_ecs_breaker_stats();
+      if ((breaker_stats.successes + breaker_stats.failures) > 0)
+      {
+        const char *breaker_state = (breaker_stats.state == BreakerState::CLOSED) ? "closed" : ((breaker_stats.state == BreakerState::OPEN) ? "open" : "half-open");
+        std::cout << "AGENT:: ECS API:: circuit " << breaker_state << ", timeout " << breaker_stats.timeout.count() << " ms, failures "
+                  << breaker_stats.failures << ", rejected " << breaker_stats.rejected << ", trips " << breaker_stats.trips << std::endl;
+      }
+
+      // Shutdown is not always clean (SIGKILL, crash), so the cache is also saved with every status
+      cs_agent.save_classification_cache();
     }
-  }
+    loop_counter++;
+  });
+  ros::AsyncSpinner master_spinner(1, &master_cb_queue);
+  master_spinner.start();
+
+  // Block until shutdown is requested by a signal or by the master check
+  ros::waitForShutdown();
+  master_spinner.stop();
 
   return 0;
-}
\ No newline at end of file
+}
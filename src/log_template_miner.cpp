@@ -0,0 +1,257 @@
+#include <error_resolution_diagnoser/log_template_miner.h>
+#include <algorithm>
+
+const std::string LogTemplateMiner::WILDCARD = "<*>";
+
+static size_t string_bytes(const std::string &text)
+{
+    // Short strings live inside the object, longer ones own a heap buffer
+    return (text.capacity() >= sizeof(std::string)) ? (text.capacity() + 1) : 0;
+}
+
+static size_t cluster_bytes(const std::vector<std::string> &tokens)
+{
+    // Approximate footprint: map node with bucket pointer, LRU list node, leaf slot and the token vector
+    size_t bytes = 64 + 4 * sizeof(void *) + 2 * sizeof(uint64_t) + tokens.capacity() * sizeof(std::string);
+    for (const std::string &token : tokens)
+    {
+        bytes += string_bytes(token);
+    }
+    return bytes;
+}
+
+static size_t node_bytes(const std::string &key)
+{
+    // Approximate footprint: map node with bucket pointer, the node itself and its key
+    return 2 * sizeof(void *) + sizeof(std::string) + 128 + string_bytes(key);
+}
+
+LogTemplateMiner::LogTemplateMiner(int depth, size_t max_children)
+{
+    // Root, length layer and leaf take three levels, at least one token layer is needed
+    this->depth = (depth < 3) ? 3 : depth;
+    this->max_children = max_children;
+    this->next_id = 1;
+    this->max_entries = 0;
+    this->max_bytes = 0;
+    this->bytes = 0;
+    this->evictions = 0;
+}
+
+std::vector<std::string> LogTemplateMiner::tokenize(const std::string &msg_text) const
+{
+    // Split on whitespace. Only tokens carrying a digit are variables, this collapses coordinates, costs,
+    // durations and IDs while words stay constant.
+    std::vector<std::string> tokens;
+    size_t idx = 0;
+
+    while (idx < msg_text.size())
+    {
+        while ((idx < msg_text.size()) && isspace(static_cast<unsigned char>(msg_text[idx])))
+        {
+            idx++;
+        }
+        size_t start = idx;
+        bool has_digit = false;
+        while ((idx < msg_text.size()) && !isspace(static_cast<unsigned char>(msg_text[idx])))
+        {
+            has_digit = has_digit || isdigit(static_cast<unsigned char>(msg_text[idx]));
+            idx++;
+        }
+        if (idx > start)
+        {
+            tokens.push_back(has_digit ? WILDCARD : msg_text.substr(start, idx - start));
+        }
+    }
+
+    return tokens;
+}
+
+LogTemplateMiner::ParseNode *LogTemplateMiner::descend(const std::vector<std::string> &tokens)
+{
+    // First layer groups messages by token count
+    auto length_node = this->length_nodes.find(tokens.size());
+    if (length_node == this->length_nodes.end())
+    {
+        length_node = this->length_nodes.emplace(tokens.size(), ParseNode()).first;
+        length_node->second.parent = nullptr;
+        length_node->second.length = tokens.size();
+        this->bytes += node_bytes(length_node->second.key);
+    }
+    ParseNode *node = &(length_node->second);
+
+    // Following layers are keyed by leading tokens, up to depth - 3 of them
+    size_t token_layers = static_cast<size_t>(this->depth - 3);
+    for (size_t idx = 0; (idx < token_layers) && (idx < tokens.size()); idx++)
+    {
+        const std::string &token = tokens[idx];
+        auto child = node->children.find(token);
+
+        if (child == node->children.end())
+        {
+            // New token. Give it a branch while there is room, keeping the last slot for the wildcard branch.
+            if ((token != WILDCARD) && (node->children.size() + 1 >= this->max_children))
+            {
+                child = node->children.find(WILDCARD);
+            }
+            if (child == node->children.end())
+            {
+                const std::string &key = (node->children.size() + 1 >= this->max_children) ? WILDCARD : token;
+                child = node->children.emplace(key, std::unique_ptr<ParseNode>(new ParseNode())).first;
+                child->second->parent = node;
+                child->second->key = key;
+                child->second->length = tokens.size();
+                this->bytes += node_bytes(key);
+            }
+        }
+
+        node = child->second.get();
+    }
+
+    return node;
+}
+
+bool LogTemplateMiner::matches(const TemplateCluster &cluster, const std::vector<std::string> &tokens) const
+{
+    // Variable positions are masked by tokenize, so a message belongs to a template only if every token is the same
+    for (size_t idx = 0; idx < tokens.size(); idx++)
+    {
+        if (cluster.tokens[idx] != tokens[idx])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t LogTemplateMiner::add_message(const std::string &msg_text)
+{
+    std::vector<std::string> tokens = this->tokenize(msg_text);
+    ParseNode *leaf = this->descend(tokens);
+
+    // Messages that only differ in their numbers share a template, the ID stays the same
+    for (uint64_t cluster_id : leaf->clusters)
+    {
+        TemplateCluster &cluster = this->clusters.at(cluster_id);
+        if (this->matches(cluster, tokens))
+        {
+            // Mark as most recently matched
+            this->lru.splice(this->lru.end(), this->lru, cluster.recent);
+            this->evict(cluster_id);
+            return cluster_id;
+        }
+    }
+
+    // No match, start a new template
+    uint64_t id = this->next_id++;
+    TemplateCluster &cluster = this->clusters[id];
+    cluster.id = id;
+    cluster.tokens = tokens;
+    cluster.leaf = leaf;
+    cluster.bytes = cluster_bytes(cluster.tokens);
+    cluster.recent = this->lru.insert(this->lru.end(), id);
+    leaf->clusters.push_back(id);
+    this->bytes += cluster.bytes;
+
+    this->evict(id);
+    return id;
+}
+
+void LogTemplateMiner::remove(uint64_t id)
+{
+    auto found = this->clusters.find(id);
+    if (found == this->clusters.end())
+    {
+        return;
+    }
+
+    ParseNode *node = found->second.leaf;
+    node->clusters.erase(std::find(node->clusters.begin(), node->clusters.end(), id));
+    this->lru.erase(found->second.recent);
+    this->bytes -= found->second.bytes;
+    this->clusters.erase(found);
+
+    // Prune the branch up to the first node still in use, so unique messages do not leave the tree behind
+    while (node->clusters.empty() && node->children.empty())
+    {
+        ParseNode *parent = node->parent;
+        this->bytes -= node_bytes(node->key);
+        if (parent == nullptr)
+        {
+            this->length_nodes.erase(node->length);
+            break;
+        }
+        std::string key = node->key;
+        parent->children.erase(key);
+        node = parent;
+    }
+}
+
+void LogTemplateMiner::evict(uint64_t keep)
+{
+    // The template just matched is the most recently used, so it is only reached once every other one is gone
+    while (((this->max_entries > 0) && (this->clusters.size() > this->max_entries)) ||
+           ((this->max_bytes > 0) && (this->bytes > this->max_bytes)))
+    {
+        uint64_t oldest = this->lru.front();
+        if (oldest == keep)
+        {
+            break;
+        }
+        this->remove(oldest);
+        this->evictions++;
+    }
+}
+
+void LogTemplateMiner::set_limits(size_t max_entries, size_t max_bytes)
+{
+    this->max_entries = max_entries;
+    this->max_bytes = max_bytes;
+    this->evict(0);
+}
+
+StateUsage LogTemplateMiner::usage() const
+{
+    StateUsage current;
+    current.entries = this->clusters.size();
+    current.bytes = this->bytes;
+    current.evictions = this->evictions;
+    return current;
+}
+
+std::string LogTemplateMiner::get_template(uint64_t id) const
+{
+    // Join template tokens back with single spaces
+    std::string template_text;
+
+    auto found = this->clusters.find(id);
+    if (found == this->clusters.end())
+    {
+        return template_text;
+    }
+
+    for (const std::string &token : found->second.tokens)
+    {
+        if (!template_text.empty())
+        {
+            template_text += " ";
+        }
+        template_text += token;
+    }
+
+    return template_text;
+}
+
+size_t LogTemplateMiner::size() const
+{
+    return this->clusters.size();
+}
+
+void LogTemplateMiner::clear()
+{
+    this->length_nodes.clear();
+    this->clusters.clear();
+    this->lru.clear();
+    this->next_id = 1;
+    this->bytes = 0;
+}
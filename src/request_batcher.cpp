@@ -0,0 +1,148 @@
+#include <error_resolution_diagnoser/request_batcher.h>
+#include <iterator>
+#include <exception>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+RequestBatcher::RequestBatcher(size_t max_batch, std::chrono::milliseconds linger, SendFunction send)
+{
+    this->max_batch = (max_batch > 0) ? max_batch : 1;
+    this->linger = linger;
+    this->send = send;
+    this->running = true;
+    this->batches = 0;
+    this->texts = 0;
+    this->flusher = std::thread(&RequestBatcher::flush_loop, this);
+}
+
+RequestBatcher::~RequestBatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->batch_mutex);
+        this->running = false;
+    }
+    this->batch_cv.notify_one();
+    this->flusher.join();
+}
+
+pplx::task<json::value> RequestBatcher::submit(const std::string &text)
+{
+    PendingText entry;
+    entry.text = text;
+    pplx::task<json::value> result = pplx::create_task(entry.done);
+
+    std::lock_guard<std::mutex> lock(this->batch_mutex);
+    if (this->pending.empty())
+    {
+        this->oldest = std::chrono::steady_clock::now();
+    }
+    this->pending.push_back(std::move(entry));
+
+    // Flusher only needs waking to start the linger time or to send a full batch
+    if ((this->pending.size() == 1) || (this->pending.size() >= this->max_batch))
+    {
+        this->batch_cv.notify_one();
+    }
+    return result;
+}
+
+void RequestBatcher::flush_loop()
+{
+    std::unique_lock<std::mutex> lock(this->batch_mutex);
+
+    while (true)
+    {
+        if (this->pending.empty())
+        {
+            if (!this->running)
+            {
+                break;
+            }
+            this->batch_cv.wait(lock);
+            continue;
+        }
+
+        // Send once full, lingered or stopping, otherwise wait for more texts to join
+        std::chrono::steady_clock::time_point deadline = this->oldest + this->linger;
+        if ((this->pending.size() < this->max_batch) && this->running && (std::chrono::steady_clock::now() < deadline))
+        {
+            this->batch_cv.wait_until(lock, deadline);
+            continue;
+        }
+
+        std::vector<PendingText> batch;
+        if (this->pending.size() > this->max_batch)
+        {
+            // Texts beyond a full batch start the next one, still oldest first
+            batch.assign(std::make_move_iterator(this->pending.begin()), std::make_move_iterator(this->pending.begin() + this->max_batch));
+            this->pending.erase(this->pending.begin(), this->pending.begin() + this->max_batch);
+        }
+        else
+        {
+            batch.swap(this->pending);
+        }
+        this->batches++;
+        this->texts += batch.size();
+
+        // Request is built and sent without holding the lock so submitters never wait on it
+        lock.unlock();
+        this->dispatch(std::move(batch));
+        lock.lock();
+    }
+}
+
+void RequestBatcher::dispatch(std::vector<PendingText> batch)
+{
+    std::vector<std::string> batch_texts;
+    batch_texts.reserve(batch.size());
+    for (const PendingText &entry : batch)
+    {
+        batch_texts.push_back(entry.text);
+    }
+
+    pplx::task<std::vector<json::value>> request;
+    try
+    {
+        request = this->send(batch_texts);
+    }
+    catch (...)
+    {
+        for (const PendingText &entry : batch)
+        {
+            entry.done.set_exception(std::current_exception());
+        }
+        return;
+    }
+
+    request.then([batch](pplx::task<std::vector<json::value>> request_task) {
+        try
+        {
+            // Results come back in the order the texts were sent, missing ones are null
+            std::vector<json::value> results = request_task.get();
+            for (size_t idx = 0; idx < batch.size(); idx++)
+            {
+                batch[idx].done.set((idx < results.size()) ? results[idx] : json::value::null());
+            }
+        }
+        catch (...)
+        {
+            for (const PendingText &entry : batch)
+            {
+                entry.done.set_exception(std::current_exception());
+            }
+        }
+    });
+}
+
+uint64_t RequestBatcher::batch_count()
+{
+    std::lock_guard<std::mutex> lock(this->batch_mutex);
+    return this->batches;
+}
+
+uint64_t RequestBatcher::text_count()
+{
+    std::lock_guard<std::mutex> lock(this->batch_mutex);
+    return this->texts;
+}
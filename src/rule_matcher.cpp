@@ -0,0 +1,373 @@
+#include <error_resolution_diagnoser/rule_matcher.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <deque>
+
+const size_t RuleMatcher::MAX_GLOB_STATES;
+
+RuleMatcher::RuleMatcher()
+{
+    memset(this->byte_class, 0, sizeof(this->byte_class));
+    this->num_classes = 1;
+    this->compiled = false;
+}
+
+uint32_t RuleMatcher::add_rule(const std::string &pattern, RuleKind kind)
+{
+    Rule rule;
+    rule.pattern = pattern;
+    rule.kind = kind;
+    this->rules.push_back(rule);
+    this->compiled = false;
+    return static_cast<uint32_t>(this->rules.size() - 1);
+}
+
+void RuleMatcher::compile()
+{
+    // Every byte a pattern matches literally gets its own class, everything else is class 0
+    memset(this->byte_class, 0, sizeof(this->byte_class));
+    this->num_classes = 1;
+    for (const Rule &rule : this->rules)
+    {
+        for (unsigned char c : rule.pattern)
+        {
+            if ((rule.kind == RuleKind::GLOB) && ((c == '*') || (c == '?')))
+            {
+                continue;
+            }
+            if (this->byte_class[c] == 0)
+            {
+                this->byte_class[c] = static_cast<uint16_t>(this->num_classes++);
+            }
+        }
+    }
+
+    this->compile_literals();
+    this->compile_globs();
+    this->compiled = true;
+}
+
+void RuleMatcher::compile_literals()
+{
+    const size_t nc = this->num_classes;
+    this->ac_next.assign(nc, -1);
+    this->ac_out.assign(1, std::vector<uint32_t>());
+    this->empty_rules.clear();
+
+    // Trie of the literal patterns
+    for (uint32_t id = 0; id < this->rules.size(); id++)
+    {
+        const Rule &rule = this->rules[id];
+        if (rule.kind == RuleKind::GLOB)
+        {
+            continue;
+        }
+        if (rule.pattern.empty())
+        {
+            this->empty_rules.push_back(id);
+            continue;
+        }
+
+        size_t node = 0;
+        for (unsigned char c : rule.pattern)
+        {
+            size_t slot = node * nc + this->byte_class[c];
+            if (this->ac_next[slot] < 0)
+            {
+                this->ac_next[slot] = static_cast<int32_t>(this->ac_out.size());
+                this->ac_next.resize(this->ac_next.size() + nc, -1);
+                this->ac_out.push_back(std::vector<uint32_t>());
+            }
+            node = static_cast<size_t>(this->ac_next[slot]);
+        }
+        this->ac_out[node].push_back(id);
+    }
+
+    // Breadth first, so the failure target of a node is complete before the node itself. Missing transitions
+    // take the one of the failure target, which turns the trie into a DFA with one lookup per byte.
+    size_t nodes = this->ac_out.size();
+    std::vector<int32_t> fail(nodes, 0);
+    this->ac_dict.assign(nodes, -1);
+    std::deque<size_t> queue;
+    for (size_t c = 0; c < nc; c++)
+    {
+        int32_t child = this->ac_next[c];
+        if (child < 0)
+        {
+            this->ac_next[c] = 0;
+        }
+        else
+        {
+            fail[child] = 0;
+            queue.push_back(static_cast<size_t>(child));
+        }
+    }
+    while (!queue.empty())
+    {
+        size_t node = queue.front();
+        queue.pop_front();
+        size_t target = static_cast<size_t>(fail[node]);
+        this->ac_dict[node] = this->ac_out[target].empty() ? this->ac_dict[target] : static_cast<int32_t>(target);
+
+        for (size_t c = 0; c < nc; c++)
+        {
+            int32_t child = this->ac_next[node * nc + c];
+            if (child < 0)
+            {
+                this->ac_next[node * nc + c] = this->ac_next[target * nc + c];
+            }
+            else
+            {
+                fail[child] = this->ac_next[target * nc + c];
+                queue.push_back(static_cast<size_t>(child));
+            }
+        }
+    }
+}
+
+void RuleMatcher::compile_globs()
+{
+    // One NFA state per pattern position plus the accepting end of each glob
+    this->glob_rules.clear();
+    this->glob_offset.assign(1, 0);
+    for (uint32_t id = 0; id < this->rules.size(); id++)
+    {
+        if (this->rules[id].kind == RuleKind::GLOB)
+        {
+            this->glob_rules.push_back(id);
+            this->glob_offset.push_back(this->glob_offset.back() + static_cast<uint32_t>(this->rules[id].pattern.size()) + 1);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(this->dfa_mutex);
+    std::atomic_store(&(this->glob_dfa), this->new_glob_dfa());
+}
+
+std::shared_ptr<RuleMatcher::GlobDfa> RuleMatcher::new_glob_dfa() const
+{
+    std::shared_ptr<GlobDfa> dfa = std::make_shared<GlobDfa>();
+    dfa->states.resize(MAX_GLOB_STATES);
+
+    // Dead state first, then the start state with every glob at its first position
+    std::vector<uint32_t> dead;
+    this->glob_state(*dfa, dead);
+    std::vector<uint32_t> start;
+    for (size_t idx = 0; idx < this->glob_rules.size(); idx++)
+    {
+        start.push_back(this->glob_offset[idx]);
+    }
+    this->glob_closure(start);
+    this->glob_state(*dfa, start);
+    return dfa;
+}
+
+void RuleMatcher::glob_closure(std::vector<uint32_t> &states) const
+{
+    // A '*' may match nothing, so the position after it is reachable too
+    size_t glob = 0;
+    std::vector<uint32_t> closed;
+    for (uint32_t state : states)
+    {
+        while (state >= this->glob_offset[glob + 1])
+        {
+            glob++;
+        }
+        const std::string &pattern = this->rules[this->glob_rules[glob]].pattern;
+        size_t pos = state - this->glob_offset[glob];
+        closed.push_back(state);
+        while ((pos < pattern.size()) && (pattern[pos] == '*'))
+        {
+            pos++;
+            closed.push_back(this->glob_offset[glob] + static_cast<uint32_t>(pos));
+        }
+    }
+
+    std::sort(closed.begin(), closed.end());
+    closed.erase(std::unique(closed.begin(), closed.end()), closed.end());
+    states.swap(closed);
+}
+
+int32_t RuleMatcher::glob_state(GlobDfa &dfa, std::vector<uint32_t> &states) const
+{
+    auto found = dfa.index.find(states);
+    if (found != dfa.index.end())
+    {
+        return found->second;
+    }
+
+    // First glob, in rule order, whose end state is in the set
+    std::unique_ptr<GlobState> built(new GlobState());
+    built->accept = -1;
+    size_t glob = 0;
+    for (uint32_t state : states)
+    {
+        while (state >= this->glob_offset[glob + 1])
+        {
+            glob++;
+        }
+        if (state == this->glob_offset[glob + 1] - 1)
+        {
+            int32_t id = static_cast<int32_t>(this->glob_rules[glob]);
+            built->accept = ((built->accept < 0) || (id < built->accept)) ? id : built->accept;
+        }
+    }
+    built->next.reset(new std::atomic<int32_t>[this->num_classes]);
+    for (size_t c = 0; c < this->num_classes; c++)
+    {
+        built->next[c].store(-1, std::memory_order_relaxed);
+    }
+
+    // Readers only reach the new state through a transition stored after this, with release order
+    int32_t dfa_state = static_cast<int32_t>(dfa.sets.size());
+    dfa.states[dfa_state] = std::move(built);
+    dfa.sets.push_back(states);
+    dfa.index[states] = dfa_state;
+    return dfa_state;
+}
+
+int32_t RuleMatcher::glob_step(std::shared_ptr<GlobDfa> &dfa, int32_t dfa_state, uint16_t byte_class)
+{
+    // Transitions already built are followed without the lock
+    int32_t next_state = dfa->states[dfa_state]->next[byte_class].load(std::memory_order_acquire);
+    if (next_state >= 0)
+    {
+        return next_state;
+    }
+
+    std::lock_guard<std::mutex> lock(this->dfa_mutex);
+    next_state = dfa->states[dfa_state]->next[byte_class].load(std::memory_order_relaxed);
+    if (next_state >= 0)
+    {
+        return next_state;
+    }
+
+    // Advance every NFA state of the set over a byte of this class
+    std::vector<uint32_t> current(dfa->sets[dfa_state]);
+    std::vector<uint32_t> next;
+    size_t glob = 0;
+    for (uint32_t state : current)
+    {
+        while (state >= this->glob_offset[glob + 1])
+        {
+            glob++;
+        }
+        const std::string &pattern = this->rules[this->glob_rules[glob]].pattern;
+        size_t pos = state - this->glob_offset[glob];
+        if (pos >= pattern.size())
+        {
+            continue;
+        }
+        unsigned char c = pattern[pos];
+        if (c == '*')
+        {
+            next.push_back(state);
+        }
+        else if ((c == '?') || ((this->byte_class[c] == byte_class) && (byte_class != 0)))
+        {
+            next.push_back(state + 1);
+        }
+    }
+    this->glob_closure(next);
+
+    // Bound the cache, patterns with many '*' can make a lot of sets. Matches still walking a full cache keep it
+    // until they finish, this one carries on in the current cache or in a new one if that is full too.
+    if (dfa->sets.size() + 1 >= MAX_GLOB_STATES)
+    {
+        std::shared_ptr<GlobDfa> latest = std::atomic_load(&(this->glob_dfa));
+        if ((latest == dfa) || (latest->sets.size() + 1 >= MAX_GLOB_STATES))
+        {
+            latest = this->new_glob_dfa();
+            std::atomic_store(&(this->glob_dfa), latest);
+        }
+        dfa = latest;
+        dfa_state = this->glob_state(*dfa, current);
+    }
+
+    next_state = this->glob_state(*dfa, next);
+    dfa->states[dfa_state]->next[byte_class].store(next_state, std::memory_order_release);
+    return next_state;
+}
+
+bool RuleMatcher::literal_applies(uint32_t id, size_t end, size_t length) const
+{
+    // end is one past the last matched byte
+    const Rule &rule = this->rules[id];
+    size_t start = end - rule.pattern.size();
+    switch (rule.kind)
+    {
+    case RuleKind::PREFIX:
+        return (start == 0);
+    case RuleKind::SUFFIX:
+        return (end == length);
+    case RuleKind::EXACT:
+        return (start == 0) && (end == length);
+    default:
+        return true;
+    }
+}
+
+int32_t RuleMatcher::match(const std::string &text)
+{
+    // Compiling rewrites the automata, so it must happen once before the matcher is shared between threads
+    assert(this->compiled);
+
+    // An empty literal is in every text, but only equal to an empty one
+    int32_t best = -1;
+    for (uint32_t id : this->empty_rules)
+    {
+        if ((this->rules[id].kind != RuleKind::EXACT) || text.empty())
+        {
+            best = static_cast<int32_t>(id);
+            break;
+        }
+    }
+
+    // Walk the current glob DFA cache, if there are globs
+    bool globs = !(this->glob_rules.empty());
+    std::shared_ptr<GlobDfa> dfa;
+    if (globs)
+    {
+        dfa = std::atomic_load(&(this->glob_dfa));
+    }
+
+    const size_t nc = this->num_classes;
+    size_t node = 0;
+    int32_t dfa_state = globs ? 1 : 0;
+    for (size_t pos = 0; pos < text.size(); pos++)
+    {
+        uint16_t c = this->byte_class[static_cast<unsigned char>(text[pos])];
+
+        // Every literal ending here is on the dictionary chain of the current node
+        node = static_cast<size_t>(this->ac_next[node * nc + c]);
+        int32_t out = this->ac_out[node].empty() ? this->ac_dict[node] : static_cast<int32_t>(node);
+        while (out >= 0)
+        {
+            for (uint32_t id : this->ac_out[out])
+            {
+                if (((best < 0) || (static_cast<int32_t>(id) < best)) && this->literal_applies(id, pos + 1, text.size()))
+                {
+                    best = static_cast<int32_t>(id);
+                }
+            }
+            out = this->ac_dict[out];
+        }
+
+        // Dead glob state stays dead
+        if (dfa_state > 0)
+        {
+            dfa_state = this->glob_step(dfa, dfa_state, c);
+        }
+    }
+
+    if ((dfa_state > 0) && (dfa->states[dfa_state]->accept >= 0) && ((best < 0) || (dfa->states[dfa_state]->accept < best)))
+    {
+        best = dfa->states[dfa_state]->accept;
+    }
+    return best;
+}
+
+size_t RuleMatcher::size() const
+{
+    return this->rules.size();
+}
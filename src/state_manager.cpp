@@ -3,6 +3,76 @@
 using namespace web::json; // JSON features
 using namespace web;       // Common features like URIs.
 
+static float timeout_from_env(const char *env_name, float default_limit)
+{
+    // Reads a timeout in minutes from the environment, falling back to the default limit
+    if (std::getenv(env_name))
+    {
+        try
+        {
+            float limit = std::stof(std::getenv(env_name));
+            std::cout << env_name << ": " << limit << " min" << std::endl;
+            return limit;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << env_name << " is set to an invalid value. Defaulting to " << default_limit << " min." << std::endl;
+        }
+    }
+
+    return default_limit;
+}
+
+static size_t limit_from_env(const char *env_name, size_t default_limit)
+{
+    // Reads a size limit from the environment, falling back to the default limit
+    if (std::getenv(env_name))
+    {
+        try
+        {
+            size_t limit = std::stoul(std::getenv(env_name));
+            std::cout << env_name << ": " << limit << std::endl;
+            return limit;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << env_name << " is set to an invalid value. Defaulting to " << default_limit << "." << std::endl;
+        }
+    }
+
+    return default_limit;
+}
+
+static uint64_t hash_call_site(const rosgraph_msgs::Log &data)
+{
+    // FNV-1a over node name, file, function and line, each field closed by a separator step
+    uint64_t hash = 14695981039346656037ULL;
+    const std::string *fields[] = {&(data.name), &(data.file), &(data.function)};
+
+    for (const std::string *field : fields)
+    {
+        for (unsigned char c : *field)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        hash *= 1099511628211ULL;
+    }
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        hash ^= (data.line >> shift) & 0xff;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static uint64_t current_tick()
+{
+    // Monotonic time in tenths of a second, used as the tick of the suppression expiry wheel
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() / 100;
+}
+
 StateManager::StateManager()
 {
 
@@ -11,19 +81,150 @@ StateManager::StateManager()
 
     // Timeout parameter in minutes for alert timeout
     this->alert_timeout_limit = 5.0;
+
+    // Per severity timeouts in minutes after which a suppressed message is reported again. 0 or less never expires.
+    // Errors stay suppressed until the event is cleared unless configured otherwise.
+    this->error_timeout_limit = timeout_from_env("ALERT_TIMEOUT_ERROR", 0.0);
+    this->warning_timeout_limit = timeout_from_env("ALERT_TIMEOUT_WARNING", this->alert_timeout_limit);
+    this->info_timeout_limit = timeout_from_env("ALERT_TIMEOUT_INFO", this->alert_timeout_limit);
+
+    // Memory ceiling of each suppression table. Least recently used entries are evicted beyond it. 0 is unlimited.
+    this->set_state_limits(limit_from_env("STATE_MAX_ENTRIES", 10000), limit_from_env("STATE_MAX_BYTES", 4 * 1024 * 1024));
+
+    // Suppress ROS messages on their raw text, on their mined template so numeric variants dedupe together,
+    // or on their call site so every message formatted by the same logging statement dedupes together
+    this->dedup_mode = "TEXT";
+    if (std::getenv("LOG_DEDUP_MODE"))
+    {
+        std::string mode = std::getenv("LOG_DEDUP_MODE");
+        if ((mode == "TEXT") || (mode == "TEMPLATE") || (mode == "CALLSITE"))
+        {
+            this->dedup_mode = mode;
+            std::cout << "LOG_DEDUP_MODE: " << this->dedup_mode << std::endl;
+        }
+        else
+        {
+            std::cerr << "LOG_DEDUP_MODE is set to an invalid value. Defaulting to TEXT." << std::endl;
+        }
+    }
+
+    // Local rules compiled into one automaton classify messages in RULES mode, without any lookup
+    if (std::getenv("AGENT_TYPE") && (std::string(std::getenv("AGENT_TYPE")) == "RULES") && std::getenv("RULES_FILE"))
+    {
+        std::string rules_file = std::getenv("RULES_FILE");
+        this->rules.reset(new ClassificationRules());
+        size_t count = this->rules->load(rules_file);
+        std::cout << "RULES_FILE: " << rules_file << ", rules loaded: " << count << std::endl;
+        if (count == 0)
+        {
+            // Missing, invalid and empty files all leave nothing to classify with
+            std::cerr << "RULES_FILE has no usable classification rules." << std::endl;
+            this->rules.reset();
+        }
+    }
+}
+
+void StateManager::set_state_limits(size_t max_entries, size_t max_bytes)
+{
+    // Apply the same ceiling to message and diagnostic state and to mined templates
+    this->msg_data.set_limits(max_entries, max_bytes);
+    this->diag_data.set_limits(max_entries, max_bytes);
+    std::lock_guard<std::mutex> lock(this->template_mutex);
+    this->template_miner.set_limits(max_entries, max_bytes);
+}
+
+StateUsage StateManager::get_msg_usage()
+{
+    // Entries, footprint and evictions of the message suppression table
+    return this->msg_data.usage();
+}
+
+StateUsage StateManager::get_diag_usage()
+{
+    // Entries, footprint and evictions of the diagnostics state table
+    return this->diag_data.usage();
+}
+
+ClassificationStats StateManager::get_classification_stats()
+{
+    // Hits, misses and size of the classification cache in front of the API
+    return this->api_instance.get_classification_stats();
+}
+
+bool StateManager::save_classification_cache()
+{
+    // Cache is guarded by itself
+    return this->api_instance.save_classification_cache();
+}
+
+BreakerStats StateManager::get_ecs_breaker_stats()
+{
+    // State of the circuit breaker in front of the API
+    return this->api_instance.get_ecs_breaker_stats();
+}
+
+size_t StateManager::get_rule_count()
+{
+    // Rules are compiled once at startup
+    return (this->rules != nullptr) ? this->rules->size() : 0;
+}
+
+std::string StateManager::get_agent_type()
+{
+    return this->api_instance.get_agent_type();
+}
+
+size_t StateManager::get_template_count()
+{
+    // Templates are kept across events so their IDs stay stable
+    std::lock_guard<std::mutex> lock(this->template_mutex);
+    return this->template_miner.size();
+}
+
+StateUsage StateManager::get_template_usage()
+{
+    // Templates, footprint and evictions of the template miner
+    std::lock_guard<std::mutex> lock(this->template_mutex);
+    return this->template_miner.usage();
+}
+
+std::string StateManager::suppression_key(const rosgraph_msgs::Log::ConstPtr &data)
+{
+    if (this->dedup_mode == "TEMPLATE")
+    {
+        // Suppress on the stable template ID, the raw text still goes into the event
+        std::lock_guard<std::mutex> lock(this->template_mutex);
+        return "template:" + std::to_string(this->template_miner.add_message(data->msg));
+    }
+    else if ((this->dedup_mode == "CALLSITE") && !(data->file.empty()))
+    {
+        // Suppress on a fixed size fingerprint of node and call site, the message body is never compared.
+        // Messages without call site information fall back to their raw text.
+        char key[sizeof "callsite:0123456789abcdef"];
+        snprintf(key, sizeof key, "callsite:%016llx", static_cast<unsigned long long>(hash_call_site(*data)));
+        return std::string(key);
+    }
+
+    return data->msg;
 }
 
 std::vector<std::string> StateManager::does_exist(std::string robot_code, std::string msg_text)
 {
 
     // Find if msg is already recorded for the given robot code
-    std::vector<std::vector<std::string>>::const_iterator row;
+    MessageState *state = this->msg_data.find(robot_code, msg_text);
 
-    for (row = this->msg_data.begin(); row != this->msg_data.end(); row++)
+    if (state != nullptr)
     {
-        if ((find(row->begin(), row->end(), msg_text) != row->end()) &&
-            (find(row->begin(), row->end(), robot_code) != row->end()))
-            return *(row);
+        // Rebuild the row as robot code, message and time recorded
+        char buf[TimestampFormatter::ISO_SECONDS_SIZE];
+        size_t len = TimestampFormatter::local().format_iso_seconds(state->timestamp, buf);
+
+        std::vector<std::string> row;
+        row.push_back(robot_code);
+        row.push_back(msg_text);
+        row.push_back(std::string(buf, len));
+        return row;
     }
 
     std::vector<std::string> emptyString;
@@ -32,7 +233,21 @@ std::vector<std::string> StateManager::does_exist(std::string robot_code, std::s
     return emptyString;
 }
 
-void StateManager::check_message(std::string agent_type, std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, json::value telemetry)
+pplx::task<json::value> StateManager::classify_message(const std::string &msg_text)
+{
+    // Local rules answer in place
+    if (this->rules != nullptr)
+    {
+        json::value row = json::value::null();
+        this->rules->classify(msg_text, row);
+        return pplx::task_from_result(row);
+    }
+
+    // Only touches the classification cache and client pool, so it can be started without holding the state
+    return this->api_instance.classify_async(msg_text);
+}
+
+void StateManager::check_message(std::string agent_type, std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, const Telemetry &telemetry)
 {
 
     if (agent_type == "ECS")
@@ -45,6 +260,10 @@ void StateManager::check_message(std::string agent_type, std::string robot_code,
         // std::cout << "Checking with ERT..." << std::endl;
         this->check_message_ert(robot_code, data, telemetry);
     }
+    else if (agent_type == "RULES")
+    {
+        this->check_message_rules(robot_code, data, telemetry);
+    }
     else
     {
         // std::cout << "Checking with ROS..." << std::endl;
@@ -52,7 +271,26 @@ void StateManager::check_message(std::string agent_type, std::string robot_code,
     }
 }
 
-void StateManager::check_message_ecs(std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, json::value telemetry)
+void StateManager::check_message(std::string agent_type, std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, const Telemetry &telemetry, const json::value &msg_info)
+{
+
+    if ((agent_type == "ECS") || (agent_type == "RULES"))
+    {
+        // Rule rows carry the same fields as ECS rows
+        this->check_message_ecs(robot_code, data, telemetry, msg_info);
+    }
+    else if ((agent_type == "ERT") || (agent_type == "DB"))
+    {
+        this->check_message_ert(robot_code, data, telemetry, msg_info);
+    }
+    else
+    {
+        // std::cout << "Checking with ROS..." << std::endl;
+        this->check_message_ros(robot_code, data, telemetry);
+    }
+}
+
+void StateManager::check_message_ecs(std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, const Telemetry &telemetry)
 {
 
     // Parse message to query-able format
@@ -63,6 +301,12 @@ void StateManager::check_message_ecs(std::string robot_code, const rosgraph_msgs
     // Check error classification, ECS
     json::value msg_info = this->api_instance.check_error_classification(msg_text);
 
+    this->check_message_ecs(robot_code, data, telemetry, msg_info);
+}
+
+void StateManager::check_message_ecs(std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, const Telemetry &telemetry, const json::value &msg_info)
+{
+
     bool ecs_hit = !(msg_info.is_null());
     // std::cout << "ECS Hit: " << ecs_hit << std::endl;
 
@@ -75,25 +319,27 @@ void StateManager::check_message_ecs(std::string robot_code, const rosgraph_msgs
         int error_level = (msg_info.at(utility::conversions::to_string_t("severity"))).as_integer();
         // std::cout << "Level: " << error_level << std::endl;
         std::string error_msg = (msg_info.at(utility::conversions::to_string_t("error_text"))).as_string();
+        // In TEMPLATE dedup mode every variant of the message is suppressed together
+        std::string msg_key = (this->dedup_mode == "TEMPLATE") ? this->suppression_key(data) : error_msg;
         // std::cout << "Text: " << error_msg << std::endl;
 
         if ((error_level == 8) || (error_level == 16))
         {
             // std::cout << "Error... " << data->msg << std::endl;
             // Check for suppression
-            this->check_error(robot_code, error_msg);
+            this->check_error(robot_code, msg_key);
         }
         else if (error_level == 4)
         {
             // std::cout << "Warning... " << data->msg << std::endl;
             // Check for suppression
-            this->check_warning(robot_code, error_msg);
+            this->check_warning(robot_code, msg_key);
         }
         else
         {
             // std::cout << "Info... " << data->msg << std::endl;
             // Check for suppression
-            this->check_info(robot_code, error_msg);
+            this->check_info(robot_code, msg_key);
         }
 
         // Process result of event
@@ -109,7 +355,7 @@ void StateManager::check_message_ecs(std::string robot_code, const rosgraph_msgs
             this->event_instance.update_log(data, msg_info, telemetry, "ECS");
 
             // Push to stream
-            this->api_instance.push_event_log(this->event_instance.get_log());
+            this->api_instance.push_event_log(this->event_instance.get_log().back());
 
             // Get compounding flag
             bool cflag = (msg_info.at(utility::conversions::to_string_t("compounding_flag"))).as_bool();
@@ -141,7 +387,7 @@ void StateManager::check_message_ecs(std::string robot_code, const rosgraph_msgs
     }
 }
 
-void StateManager::check_message_ert(std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, json::value telemetry)
+void StateManager::check_message_ert(std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, const Telemetry &telemetry)
 {
 
     // Parse message to query-able format
@@ -152,6 +398,12 @@ void StateManager::check_message_ert(std::string robot_code, const rosgraph_msgs
     // Check error classification, ECS
     json::value msg_info = this->api_instance.check_error_classification(msg_text);
 
+    this->check_message_ert(robot_code, data, telemetry, msg_info);
+}
+
+void StateManager::check_message_ert(std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, const Telemetry &telemetry, const json::value &msg_info)
+{
+
     bool ecs_hit = !(msg_info.is_null());
     // std::cout << "ECS Hit: " << ecs_hit << std::endl;
 
@@ -164,25 +416,27 @@ void StateManager::check_message_ert(std::string robot_code, const rosgraph_msgs
         int error_level = (msg_info.at(utility::conversions::to_string_t("error_level"))).as_integer();
         // std::cout << "Level: " << error_level << std::endl;
         std::string error_msg = (msg_info.at(utility::conversions::to_string_t("error_text"))).as_string();
+        // In TEMPLATE dedup mode every variant of the message is suppressed together
+        std::string msg_key = (this->dedup_mode == "TEMPLATE") ? this->suppression_key(data) : error_msg;
         // std::cout << "Text: " << error_msg << std::endl;
 
         if (error_level == 8)
         {
             // std::cout << "Error... " << data->msg << std::endl;
             // Check for suppression
-            this->check_error(robot_code, error_msg);
+            this->check_error(robot_code, msg_key);
         }
         else if (error_level == 4)
         {
             // std::cout << "Warning... " << data->msg << std::endl;
             // Check for suppression
-            this->check_warning(robot_code, error_msg);
+            this->check_warning(robot_code, msg_key);
         }
         else
         {
             // std::cout << "Info... " << data->msg << std::endl;
             // Check for suppression
-            this->check_info(robot_code, error_msg);
+            this->check_info(robot_code, msg_key);
         }
 
         // Process result of event
@@ -198,7 +452,7 @@ void StateManager::check_message_ert(std::string robot_code, const rosgraph_msgs
             this->event_instance.update_log(data, msg_info, telemetry, "ERT");
 
             // Push to stream
-            this->api_instance.push_event_log(this->event_instance.get_log());
+            this->api_instance.push_event_log(this->event_instance.get_log().back());
 
             // Get compounding flag
             bool cflag = (msg_info.at(utility::conversions::to_string_t("compounding_flag"))).as_bool();
@@ -230,26 +484,43 @@ void StateManager::check_message_ert(std::string robot_code, const rosgraph_msgs
     }
 }
 
-void StateManager::check_message_ros(std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, json::value telemetry)
+void StateManager::check_message_rules(std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, const Telemetry &telemetry)
 {
 
+    // Classify against the local rules in one pass over the message
+    json::value msg_info = json::value::null();
+    if (this->rules != nullptr)
+    {
+        this->rules->classify(data->msg, msg_info);
+    }
+
+    // Rule rows carry the same fields as ECS rows, so hits follow the ECS message cycle
+    this->check_message_ecs(robot_code, data, telemetry, msg_info);
+}
+
+void StateManager::check_message_ros(std::string robot_code, const rosgraph_msgs::Log::ConstPtr &data, const Telemetry &telemetry)
+{
+
+    // Key to suppress this message on
+    std::string msg_key = this->suppression_key(data);
+
     if (data->level == 8)
     {
         // std::cout << "Error... " << data->msg << std::endl;
         // Check for suppression
-        this->check_error(robot_code, data->msg);
+        this->check_error(robot_code, msg_key);
     }
     else if (data->level == 4)
     {
         // std::cout << "Warning... " << data->msg << std::endl;
         // Check for suppression
-        this->check_warning(robot_code, data->msg);
+        this->check_warning(robot_code, msg_key);
     }
     else
     {
         // std::cout << "Info... " << data->msg << std::endl;
         // Check for suppression
-        this->check_info(robot_code, data->msg);
+        this->check_info(robot_code, msg_key);
     }
 
     // Process result of event
@@ -265,7 +536,7 @@ void StateManager::check_message_ros(std::string robot_code, const rosgraph_msgs
         this->event_instance.update_log(data, json::value::null(), telemetry, "ROS");
 
         // Push log
-        this->api_instance.push_event_log(this->event_instance.get_log());
+        this->api_instance.push_event_log(this->event_instance.get_log().back());
 
         if ((data->level == 8) || (data->msg == "Goal reached"))
         {
@@ -282,145 +553,66 @@ void StateManager::check_message_ros(std::string robot_code, const rosgraph_msgs
 
 void StateManager::check_error(std::string robot_code, std::string msg_text)
 {
-
-    std::vector<std::string> found = this->does_exist(robot_code, msg_text);
-    bool exist;
-
-    if (found[0] == "")
-    {
-        exist = false;
-    }
-    else
-    {
-        exist = true;
-    }
-
-    if (exist)
-    {
-        // Found, suppress
-        this->suppress_flag = true;
-    }
-    else
-    {
-        // Not found, add to data
-
-        std::vector<std::string> msg_details;
-
-        // Get current time
-        time_t now;
-        time(&now);
-        char buf[sizeof "2011-10-08T07:07:09Z"];
-        strftime(buf, sizeof buf, "%FT%TZ", gmtime(&now));
-        std::string time_str = std::string(buf);
-
-        // Push details to data
-        msg_details.push_back(robot_code);
-        msg_details.push_back(msg_text);
-        msg_details.push_back(time_str);
-        this->msg_data.push_back(msg_details);
-
-        // Do not suppress
-        this->suppress_flag = false;
-    }
+    // Check error suppression
+    this->check_suppression(robot_code, msg_text, this->error_timeout_limit);
 }
 
 void StateManager::check_warning(std::string robot_code, std::string msg_text)
 {
-
-    std::vector<std::string> found = this->does_exist(robot_code, msg_text);
-    bool exist;
-
-    if (found[0] == "")
-    {
-        exist = false;
-    }
-    else
-    {
-        exist = true;
-    }
-
-    if (exist)
-    {
-        // Found, check timeout limit - not implemented yet
-        this->suppress_flag = true;
-    }
-    else
-    {
-        // Not found, add to data
-
-        std::vector<std::string> msg_details;
-
-        // Get current time
-        time_t now;
-        time(&now);
-        char buf[sizeof "2011-10-08T07:07:09Z"];
-        strftime(buf, sizeof buf, "%FT%TZ", gmtime(&now));
-        std::string time_str = std::string(buf);
-
-        // Push details to data
-        msg_details.push_back(robot_code);
-        msg_details.push_back(msg_text);
-        msg_details.push_back(time_str);
-        this->msg_data.push_back(msg_details);
-
-        // Do not suppress
-        this->suppress_flag = false;
-    }
+    // Check warning suppression
+    this->check_suppression(robot_code, msg_text, this->warning_timeout_limit);
 }
 
 void StateManager::check_info(std::string robot_code, std::string msg_text)
 {
+    // Check info suppression
+    this->check_suppression(robot_code, msg_text, this->info_timeout_limit);
+}
 
-    std::vector<std::string> found = this->does_exist(robot_code, msg_text);
-    bool exist;
+void StateManager::check_suppression(const std::string &robot_code, const std::string &msg_text, float timeout_limit)
+{
+    // Drop every message whose timeout has passed so repeat alerts resurface
+    uint64_t now = current_tick();
+    this->msg_data.expire(now);
 
-    if (found[0] == "")
-    {
-        exist = false;
-        // std::cout << "Msg found status: False" << std::endl;
-    }
-    else
-    {
-        exist = true;
-        // std::cout << "Msg found status: True" << std::endl;
-    }
+    // Check if message is already recorded for this robot
+    bool exist = (this->msg_data.find(robot_code, msg_text) != nullptr);
 
     if (exist)
     {
-        // Found, suppress
+        // Found and not yet timed out, suppress
         this->suppress_flag = true;
     }
     else
     {
         // Not found, add to data
 
-        std::vector<std::string> msg_details;
-
         // Get current time
-        time_t now;
-        time(&now);
-        char buf[sizeof "2011-10-08T07:07:09Z"];
-        strftime(buf, sizeof buf, "%FT%TZ", gmtime(&now));
-        std::string time_str = std::string(buf);
+        MessageState msg_details;
+        msg_details.timestamp = Timestamp::now().sec;
+
+        // Schedule expiry, rounded up to the next whole tick
+        uint64_t expiry = 0;
+        if (timeout_limit > 0)
+        {
+            expiry = now + std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(timeout_limit * 600.0)));
+        }
 
         // Push details to data
-        msg_details.push_back(robot_code);
-        msg_details.push_back(msg_text);
-        msg_details.push_back(time_str);
-        this->msg_data.push_back(msg_details);
+        this->msg_data.insert(robot_code, msg_text, msg_details, expiry);
 
         // Do not suppress
         this->suppress_flag = false;
     }
 }
 
-void StateManager::check_heartbeat(bool status, json::value telemetry)
+void StateManager::check_heartbeat(bool status, const Telemetry &telemetry)
 {
     // Pass data to backend to push appropriate status
     this->api_instance.push_status(status, telemetry);
 }
 
-void StateManager::check_diagnostic(std::string agent_type, std::string robot_code, std::vector<diagnostic_msgs::DiagnosticStatus> current_diag, json::value telemetry)
+void StateManager::check_diagnostic(std::string agent_type, std::string robot_code, const std::vector<diagnostic_msgs::DiagnosticStatus> &current_diag, const Telemetry &telemetry)
 {
     // this->check_diagnostic_ros(robot_code, current_diag, telemetry);
     if (agent_type == "ECS")
@@ -440,7 +632,7 @@ void StateManager::check_diagnostic(std::string agent_type, std::string robot_co
     }
 }
 
-void StateManager::check_diagnostic_ros(std::string robot_code, std::vector<diagnostic_msgs::DiagnosticStatus> current_diag, json::value telemetry)
+void StateManager::check_diagnostic_ros(std::string robot_code, const std::vector<diagnostic_msgs::DiagnosticStatus> &current_diag, const Telemetry &telemetry)
 {
     // Check diagnostic data and if not suppressed, push it to the event
 
@@ -458,7 +650,7 @@ void StateManager::check_diagnostic_ros(std::string robot_code, std::vector<diag
         // std::cout << "Checking: " << diag_level << " " << diag_str << std::endl;
         // Check if diagnostic needs to be suppressed. All diagnostics with the same str
         // and no change in level are suppressed. We process only when there is change in levels.
-        this->check_diag_data(robot_code, diag_str, std::to_string(diag_level));
+        this->check_diag_data(robot_code, diag_str, static_cast<DiagLevel>(diag_level));
 
         if (this->suppress_flag)
         {
@@ -516,7 +708,7 @@ void StateManager::check_diagnostic_ros(std::string robot_code, std::vector<diag
             this->event_instance.update_log(data, json::value::null(), telemetry, "ROS");
 
             // Push log
-            this->api_instance.push_event_log(this->event_instance.get_log());
+            this->api_instance.push_event_log(this->event_instance.get_log().back());
 
             // if (data->level == 8)
             // {
@@ -532,7 +724,7 @@ void StateManager::check_diagnostic_ros(std::string robot_code, std::vector<diag
     }
 }
 
-void StateManager::check_diagnostic_ert(std::string robot_code, std::vector<diagnostic_msgs::DiagnosticStatus> current_diag, json::value telemetry)
+void StateManager::check_diagnostic_ert(std::string robot_code, const std::vector<diagnostic_msgs::DiagnosticStatus> &current_diag, const Telemetry &telemetry)
 {
     // Check diagnostic data and if not suppressed, push it to the event
 
@@ -549,7 +741,7 @@ void StateManager::check_diagnostic_ert(std::string robot_code, std::vector<diag
         diag_level = static_cast<int>(current_diag[idx].level);
         // Check if diagnostic needs to be suppressed. All diagnostics with the same str
         // and no change in level are suppressed. We process only when there is change in levels.
-        this->check_diag_data(robot_code, diag_str, std::to_string(diag_level));
+        this->check_diag_data(robot_code, diag_str, static_cast<DiagLevel>(diag_level));
 
         if (this->suppress_flag)
         {
@@ -627,7 +819,7 @@ void StateManager::check_diagnostic_ert(std::string robot_code, std::vector<diag
                 this->event_instance.update_log(data, msg_info, telemetry, "ERT");
 
                 // Push log
-                this->api_instance.push_event_log(this->event_instance.get_log());
+                this->api_instance.push_event_log(this->event_instance.get_log().back());
             }
             else
             {
@@ -648,7 +840,7 @@ void StateManager::check_diagnostic_ert(std::string robot_code, std::vector<diag
     }
 }
 
-void StateManager::check_diagnostic_ecs(std::string robot_code, std::vector<diagnostic_msgs::DiagnosticStatus> current_diag, json::value telemetry)
+void StateManager::check_diagnostic_ecs(std::string robot_code, const std::vector<diagnostic_msgs::DiagnosticStatus> &current_diag, const Telemetry &telemetry)
 {
     // Check diagnostic data and if not suppressed, push it to the event
 
@@ -665,7 +857,7 @@ void StateManager::check_diagnostic_ecs(std::string robot_code, std::vector<diag
         diag_level = static_cast<int>(current_diag[idx].level);
         // Check if diagnostic needs to be suppressed. All diagnostics with the same str
         // and no change in level are suppressed. We process only when there is change in levels.
-        this->check_diag_data(robot_code, diag_str, std::to_string(diag_level));
+        this->check_diag_data(robot_code, diag_str, static_cast<DiagLevel>(diag_level));
 
         if (this->suppress_flag)
         {
@@ -743,7 +935,7 @@ void StateManager::check_diagnostic_ecs(std::string robot_code, std::vector<diag
                 this->event_instance.update_log(data, msg_info, telemetry, "ECS");
 
                 // Push log
-                this->api_instance.push_event_log(this->event_instance.get_log());
+                this->api_instance.push_event_log(this->event_instance.get_log().back());
             }
             else
             {
@@ -765,44 +957,41 @@ void StateManager::check_diagnostic_ecs(std::string robot_code, std::vector<diag
 }
 
 void StateManager::check_diag_data(std::string robot_code, std::string diag_str, std::string level)
+{
+    // Check diagnostic suppression for a level given as its numeric string
+    this->check_diag_data(robot_code, diag_str, static_cast<DiagLevel>(std::stoi(level)));
+}
+
+void StateManager::check_diag_data(const std::string &robot_code, const std::string &diag_str, DiagLevel level)
 {
     // Check if diagnostic already reported
-    std::vector<std::string> found = this->does_diag_exist(robot_code, diag_str, level);
-    bool exist;
+    DiagnosticState *state = this->diag_data.find(robot_code, diag_str);
 
-    if (found[0] == "")
+    if ((state != nullptr) && (state->level == level))
     {
-        exist = false;
+        // Found at the same level, suppress
+        this->suppress_flag = true;
     }
-    else
+    else if (state != nullptr)
     {
-        exist = true;
-    }
+        // Found at a different level. State has changed, update the entry in place
+        state->level = level;
+        state->timestamp = Timestamp::now().sec;
 
-    if (exist)
-    {
-        // Found, suppress
-        this->suppress_flag = true;
+        // Do not suppress
+        this->suppress_flag = false;
     }
     else
     {
         // Not found, add to data
 
-        std::vector<std::string> diag_details;
-
         // Get current time
-        time_t now;
-        time(&now);
-        char buf[sizeof "2011-10-08T07:07:09Z"];
-        strftime(buf, sizeof buf, "%FT%TZ", gmtime(&now));
-        std::string time_str = std::string(buf);
+        DiagnosticState diag_details;
+        diag_details.level = level;
+        diag_details.timestamp = Timestamp::now().sec;
 
         // Push details to data
-        diag_details.push_back(robot_code);
-        diag_details.push_back(diag_str);
-        diag_details.push_back(level);
-        diag_details.push_back(time_str);
-        this->diag_data.push_back(diag_details);
+        this->diag_data.insert(robot_code, diag_str, diag_details);
 
         // Do not suppress
         this->suppress_flag = false;
@@ -813,36 +1002,20 @@ std::vector<std::string> StateManager::does_diag_exist(std::string robot_code, s
 {
 
     // Find if diagnostic is already recorded for the given robot code at the given level
-    std::vector<std::vector<std::string>>::const_iterator row;
-    std::vector<std::vector<std::vector<std::string>>::const_iterator> erase_list;
-
-    for (row = this->diag_data.begin(); row != this->diag_data.end(); row++)
-    {
-        auto found_name = find(row->begin(), row->end(), diag_str);
-
-        if (found_name != row->end())
-        {
-            // Found name, check for other parameters
-            if ((find(row->begin(), row->end(), level) != row->end()) &&
-                (find(row->begin(), row->end(), robot_code) != row->end()))
-            {
-                // Found level as well, just return the row since it is already reported
-                return *(row);
-            }
-            else
-            {
-                // Level not found but name is. This means state has changed.
-                // Add row to erase list.
-                // Will add a new row with this name downstream.
-                erase_list.push_back(row);
-            }
-        }
-    }
+    DiagnosticState *state = this->diag_data.find(robot_code, diag_str);
 
-    // Erase elements
-    for (auto element : erase_list)
+    if ((state != nullptr) && (state->level == static_cast<DiagLevel>(std::stoi(level))))
     {
-        this->diag_data.erase(element);
+        // Found level as well, rebuild the row since it is already reported
+        char buf[TimestampFormatter::ISO_SECONDS_SIZE];
+        size_t len = TimestampFormatter::local().format_iso_seconds(state->timestamp, buf);
+
+        std::vector<std::string> row;
+        row.push_back(robot_code);
+        row.push_back(diag_str);
+        row.push_back(level);
+        row.push_back(std::string(buf, len));
+        return row;
     }
 
     // Return empty string if no match
@@ -0,0 +1,207 @@
+#include <error_resolution_diagnoser/telemetry.h>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+static json::value pose_state_to_json(const PoseState &pose)
+{
+    // Create JSON objects
+    json::value pose_json = json::value::object();
+    json::value orientation = json::value::object();
+    json::value position = json::value::object();
+
+    // Create keys
+    utility::string_t oKey(utility::conversions::to_string_t("orientation"));
+    utility::string_t pKey(utility::conversions::to_string_t("position"));
+    utility::string_t wKey(utility::conversions::to_string_t("w"));
+    utility::string_t xKey(utility::conversions::to_string_t("x"));
+    utility::string_t yKey(utility::conversions::to_string_t("y"));
+    utility::string_t zKey(utility::conversions::to_string_t("z"));
+
+    // Assign orientation key-value
+    orientation[wKey] = json::value::number(pose.orientation_w);
+    orientation[xKey] = json::value::number(pose.orientation_x);
+    orientation[yKey] = json::value::number(pose.orientation_y);
+    orientation[zKey] = json::value::number(pose.orientation_z);
+
+    // Assign position key-value
+    position[xKey] = json::value::number(pose.position_x);
+    position[yKey] = json::value::number(pose.position_y);
+    position[zKey] = json::value::number(pose.position_z);
+
+    // Assign pose key-value
+    pose_json[oKey] = orientation;
+    pose_json[pKey] = position;
+
+    return pose_json;
+}
+
+static void write_pose_state(JsonWriter &writer, const PoseState &pose)
+{
+    // Keys in the sorted order of pose_state_to_json
+    writer.begin_object();
+    writer.key("orientation");
+    writer.begin_object();
+    writer.key("w");
+    writer.number(pose.orientation_w);
+    writer.key("x");
+    writer.number(pose.orientation_x);
+    writer.key("y");
+    writer.number(pose.orientation_y);
+    writer.key("z");
+    writer.number(pose.orientation_z);
+    writer.end_object();
+    writer.key("position");
+    writer.begin_object();
+    writer.key("x");
+    writer.number(pose.position_x);
+    writer.key("y");
+    writer.number(pose.position_y);
+    writer.key("z");
+    writer.number(pose.position_z);
+    writer.end_object();
+    writer.end_object();
+}
+
+static bool same_pose(const PoseState &lhs, const PoseState &rhs)
+{
+    return (lhs.valid == rhs.valid) &&
+           (lhs.position_x == rhs.position_x) && (lhs.position_y == rhs.position_y) && (lhs.position_z == rhs.position_z) &&
+           (lhs.orientation_w == rhs.orientation_w) && (lhs.orientation_x == rhs.orientation_x) &&
+           (lhs.orientation_y == rhs.orientation_y) && (lhs.orientation_z == rhs.orientation_z);
+}
+
+json::value snapshot_to_json(const TelemetrySnapshot &snapshot)
+{
+    // Only poses that have been received are reported
+    json::value telemetry = json::value::object();
+    if (snapshot.odom_pose.valid)
+    {
+        telemetry[utility::conversions::to_string_t("odom_pose")] = pose_state_to_json(snapshot.odom_pose);
+    }
+    if (snapshot.nav_pose.valid)
+    {
+        telemetry[utility::conversions::to_string_t("nav_pose")] = pose_state_to_json(snapshot.nav_pose);
+    }
+
+    return telemetry;
+}
+
+void write_snapshot(JsonWriter &writer, const TelemetrySnapshot &snapshot)
+{
+    writer.begin_object();
+    if (snapshot.nav_pose.valid)
+    {
+        writer.key("nav_pose");
+        write_pose_state(writer, snapshot.nav_pose);
+    }
+    if (snapshot.odom_pose.valid)
+    {
+        writer.key("odom_pose");
+        write_pose_state(writer, snapshot.odom_pose);
+    }
+    writer.end_object();
+}
+
+TelemetryStore::TelemetryStore()
+{
+    this->cache_valid = false;
+    this->cached_odom_version = 0;
+    this->cached_nav_version = 0;
+}
+
+void TelemetryStore::set_odom_pose(const PoseState &pose)
+{
+    // Only the writer thread stores this pose, so reading it back here never contends.
+    // A stationary robot keeps publishing the same pose, which must not invalidate the cache.
+    if (!same_pose(this->odom_pose.load(), pose))
+    {
+        this->odom_pose.store(pose);
+    }
+}
+
+void TelemetryStore::set_nav_pose(const PoseState &pose)
+{
+    if (!same_pose(this->nav_pose.load(), pose))
+    {
+        this->nav_pose.store(pose);
+    }
+}
+
+TelemetrySnapshot TelemetryStore::snapshot() const
+{
+    // The poses are read one after the other, so the pair of versions identifies the state the snapshot holds
+    TelemetrySnapshot current;
+    current.odom_pose = this->odom_pose.load(current.odom_version);
+    current.nav_pose = this->nav_pose.load(current.nav_version);
+    return current;
+}
+
+std::shared_ptr<const std::string> TelemetryStore::serialize(const TelemetrySnapshot &snapshot) const
+{
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+    // Reuse the serialization while the poses have not changed
+    if (this->cache_valid && (this->cached_odom_version == snapshot.odom_version) && (this->cached_nav_version == snapshot.nav_version))
+    {
+        return this->cached_str;
+    }
+
+    // Own writer so serializing telemetry never disturbs a payload being written with JsonWriter::local()
+    thread_local JsonWriter writer;
+    writer.clear();
+    write_snapshot(writer, snapshot);
+    std::shared_ptr<const std::string> telemetry_str = std::make_shared<const std::string>(writer.str());
+
+    // Keep the newest versions, a snapshot with an older pose serialized late must not replace them
+    if (!(this->cache_valid) || ((snapshot.odom_version >= this->cached_odom_version) && (snapshot.nav_version >= this->cached_nav_version)))
+    {
+        this->cache_valid = true;
+        this->cached_odom_version = snapshot.odom_version;
+        this->cached_nav_version = snapshot.nav_version;
+        this->cached_str = telemetry_str;
+    }
+
+    return telemetry_str;
+}
+
+Telemetry::Telemetry()
+{
+    this->from_snapshot = false;
+    this->store = nullptr;
+    this->value = json::value::object();
+}
+
+Telemetry::Telemetry(const json::value &value)
+{
+    this->from_snapshot = false;
+    this->store = nullptr;
+    this->value = value;
+}
+
+Telemetry::Telemetry(const TelemetrySnapshot &snapshot, const TelemetryStore *store)
+{
+    this->from_snapshot = true;
+    this->snapshot = snapshot;
+    this->store = store;
+}
+
+json::value Telemetry::to_json() const
+{
+    if (!this->from_snapshot)
+    {
+        return this->value;
+    }
+
+    return snapshot_to_json(this->snapshot);
+}
+
+std::shared_ptr<const std::string> Telemetry::serialized() const
+{
+    if (this->from_snapshot && (this->store != nullptr))
+    {
+        return this->store->serialize(this->snapshot);
+    }
+
+    return std::make_shared<const std::string>(this->to_json().serialize());
+}
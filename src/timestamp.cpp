@@ -0,0 +1,124 @@
+#include <error_resolution_diagnoser/timestamp.h>
+#include <chrono>
+#include <cstring>
+
+static void write_digits(char *out, uint32_t value, int width)
+{
+    // Zero padded decimal, right aligned in width characters
+    for (int idx = width - 1; idx >= 0; idx--)
+    {
+        out[idx] = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    }
+}
+
+Timestamp Timestamp::now()
+{
+    int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+
+    Timestamp stamp;
+    stamp.sec = micros / 1000000;
+    stamp.usec = static_cast<uint32_t>(micros % 1000000);
+    return stamp;
+}
+
+Timestamp Timestamp::from_stamp(uint32_t sec, uint32_t nsec)
+{
+    Timestamp stamp;
+    stamp.sec = sec;
+    stamp.usec = nsec / 1000;
+    return stamp;
+}
+
+const size_t TimestampFormatter::ISO_SIZE;
+const size_t TimestampFormatter::ISO_SECONDS_SIZE;
+
+TimestampFormatter::TimestampFormatter()
+{
+    // Fill the cache for the epoch so it is never read uninitialized
+    this->cached_sec = 0;
+    format_civil(0, this->cached_prefix);
+}
+
+void TimestampFormatter::format_civil(int64_t sec, char *out)
+{
+    // Split into days and time of day, flooring so times before the epoch also work
+    int64_t days = sec / 86400;
+    int64_t rem = sec % 86400;
+    if (rem < 0)
+    {
+        rem += 86400;
+        days -= 1;
+    }
+
+    // Days to proleptic Gregorian date over 400 year eras starting in March, see H. Hinnant's civil_from_days
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int64_t day = doy - (153 * mp + 2) / 5 + 1;
+    int64_t month = mp < 10 ? mp + 3 : mp - 9;
+    int64_t year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+
+    write_digits(out, static_cast<uint32_t>(year), 4);
+    out[4] = '-';
+    write_digits(out + 5, static_cast<uint32_t>(month), 2);
+    out[7] = '-';
+    write_digits(out + 8, static_cast<uint32_t>(day), 2);
+    out[10] = 'T';
+    write_digits(out + 11, static_cast<uint32_t>(rem / 3600), 2);
+    out[13] = ':';
+    write_digits(out + 14, static_cast<uint32_t>((rem / 60) % 60), 2);
+    out[16] = ':';
+    write_digits(out + 17, static_cast<uint32_t>(rem % 60), 2);
+}
+
+const char *TimestampFormatter::prefix(int64_t sec)
+{
+    // Events come in bursts within the same second, recompute the date only when the second moves
+    if (sec != this->cached_sec)
+    {
+        format_civil(sec, this->cached_prefix);
+        this->cached_sec = sec;
+    }
+
+    return this->cached_prefix;
+}
+
+size_t TimestampFormatter::format_iso(const Timestamp &stamp, char *out)
+{
+    memcpy(out, this->prefix(stamp.sec), sizeof(this->cached_prefix));
+
+    // Same as boost to_iso_extended_string, which leaves out a zero fraction
+    if (stamp.usec == 0)
+    {
+        return sizeof(this->cached_prefix);
+    }
+
+    out[19] = '.';
+    write_digits(out + 20, stamp.usec, 6);
+    return ISO_SIZE;
+}
+
+size_t TimestampFormatter::format_iso_seconds(int64_t sec, char *out)
+{
+    memcpy(out, this->prefix(sec), sizeof(this->cached_prefix));
+    out[19] = 'Z';
+    return ISO_SECONDS_SIZE;
+}
+
+std::string TimestampFormatter::iso_string(const Timestamp &stamp)
+{
+    char buf[ISO_SIZE];
+    return std::string(buf, this->format_iso(stamp, buf));
+}
+
+TimestampFormatter &TimestampFormatter::local()
+{
+    thread_local TimestampFormatter formatter;
+    return formatter;
+}
@@ -0,0 +1,174 @@
+#include <error_resolution_diagnoser/timing_wheel.h>
+
+TimingWheel::TimingWheel()
+{
+    // Every slot starts as an empty circular list
+    for (int level = 0; level < LEVELS; level++)
+    {
+        for (int slot = 0; slot < SLOTS; slot++)
+        {
+            this->slots[level][slot].prev = &(this->slots[level][slot]);
+            this->slots[level][slot].next = &(this->slots[level][slot]);
+        }
+    }
+
+    this->overflow.prev = &(this->overflow);
+    this->overflow.next = &(this->overflow);
+
+    this->now = 0;
+    this->count = 0;
+}
+
+void TimingWheel::link(TimerNode *head, TimerNode *node)
+{
+    // Insert node at the tail of the slot list
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+void TimingWheel::place(TimerNode *node)
+{
+    // Nodes due now or in the past fire on the next tick
+    uint64_t expiry = node->expiry;
+    if (expiry <= this->now)
+    {
+        expiry = this->now + 1;
+    }
+
+    // Pick the lowest level whose window still contains both now and the expiry.
+    // The slot is then strictly ahead of the current position on that level, so it is
+    // reached (and cascaded down) before the expiry passes.
+    for (int level = 0; level < LEVELS; level++)
+    {
+        int shift = SLOT_BITS * (level + 1);
+        if ((expiry >> shift) == (this->now >> shift))
+        {
+            int slot = (expiry >> (SLOT_BITS * level)) & SLOT_MASK;
+            this->link(&(this->slots[level][slot]), node);
+            return;
+        }
+    }
+
+    // Beyond the range of the wheel, park the node until the top level wraps
+    this->link(&(this->overflow), node);
+}
+
+void TimingWheel::cascade(TimerNode *head, std::vector<TimerNode *> &expired)
+{
+    // Take the whole list and re-place its nodes relative to the current tick
+    TimerNode *node = head->next;
+    head->prev = head;
+    head->next = head;
+
+    while (node != head)
+    {
+        TimerNode *next = node->next;
+        if (node->expiry <= this->now)
+        {
+            node->prev = nullptr;
+            node->next = nullptr;
+            this->count--;
+            expired.push_back(node);
+        }
+        else
+        {
+            this->place(node);
+        }
+        node = next;
+    }
+}
+
+void TimingWheel::schedule(TimerNode *node, uint64_t expiry)
+{
+    // Reschedule if already on the wheel
+    this->cancel(node);
+
+    node->expiry = expiry;
+    this->place(node);
+    this->count++;
+}
+
+void TimingWheel::cancel(TimerNode *node)
+{
+    if (node->is_scheduled())
+    {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = nullptr;
+        node->next = nullptr;
+        this->count--;
+    }
+}
+
+void TimingWheel::advance(uint64_t target, std::vector<TimerNode *> &expired)
+{
+    // Nothing to expire, jump straight to the target tick
+    if (this->count == 0)
+    {
+        if (target > this->now)
+        {
+            this->now = target;
+        }
+        return;
+    }
+
+    while (this->now < target)
+    {
+        this->now++;
+
+        // Parked nodes may fall within range once the whole wheel wraps
+        if ((this->now & ((1ULL << (SLOT_BITS * LEVELS)) - 1)) == 0)
+        {
+            this->cascade(&(this->overflow), expired);
+        }
+
+        // Cascade every level whose position just wrapped, highest first so nodes can fall through
+        int top = 0;
+        while ((top < LEVELS - 1) && ((this->now & ((1ULL << (SLOT_BITS * (top + 1))) - 1)) == 0))
+        {
+            top++;
+        }
+        for (int level = top; level >= 0; level--)
+        {
+            this->cascade(&(this->slots[level][(this->now >> (SLOT_BITS * level)) & SLOT_MASK]), expired);
+        }
+
+        if (this->count == 0)
+        {
+            this->now = target;
+        }
+    }
+}
+
+void TimingWheel::clear()
+{
+    // Unlink every node so owners can be destroyed safely
+    for (int idx = 0; idx <= LEVELS * SLOTS; idx++)
+    {
+        TimerNode *head = (idx < LEVELS * SLOTS) ? &(this->slots[idx / SLOTS][idx % SLOTS]) : &(this->overflow);
+        TimerNode *node = head->next;
+        while (node != head)
+        {
+            TimerNode *next = node->next;
+            node->prev = nullptr;
+            node->next = nullptr;
+            node = next;
+        }
+        head->prev = head;
+        head->next = head;
+    }
+
+    this->count = 0;
+}
+
+uint64_t TimingWheel::current_tick() const
+{
+    return this->now;
+}
+
+size_t TimingWheel::size() const
+{
+    return this->count;
+}
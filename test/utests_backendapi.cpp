@@ -23,10 +23,8 @@ int log_id = 0;
 BackendApi api_instance;
 
 // Create sample log
-std::vector<std::vector<std::string>> sample_log;
+std::vector<EventRecord> sample_log;
 std::string time_str = "2020-07-03T05:31:40.131383";
-std::string level = "8";
-std::string cflag = "false";
 std::string module = "Null";
 std::string source = "/move_base";
 std::string message = "Aborting because a valid plan is not found";
@@ -36,27 +34,28 @@ std::string event_id_str = "Sample id";
 std::string telemetry = "{ \"pose\" : 42 }";
 
 // Hold the record
-std::vector<std::string> event_details;
+EventRecord event_details;
 
 TEST(BackEndApiTestSuite, pushTest)
 {
-  // Push to details
-  event_details.push_back(time_str);
-  event_details.push_back(level);
-  event_details.push_back(cflag);
-  event_details.push_back(module);
-  event_details.push_back(source);
-  event_details.push_back(message);
-  event_details.push_back(description);
-  event_details.push_back(resolution);
-  event_details.push_back(telemetry);
-  event_details.push_back(event_id_str);
+  // Fill details
+  event_details.time.sec = 1593754300;
+  event_details.time.usec = 131383;
+  event_details.level = EventLevel::ERROR;
+  event_details.compounding = Compounding::NO;
+  event_details.module = intern_string(module);
+  event_details.source = intern_string(source);
+  event_details.message = message;
+  event_details.description = description;
+  event_details.resolution = resolution;
+  event_details.telemetry = std::make_shared<const std::string>(telemetry);
+  event_details.event_id = std::make_shared<const std::string>(event_id_str);
 
   // Push to sample_log
   sample_log.push_back(event_details);
 
   // Push event
-  api_instance.push_event_log(sample_log);
+  api_instance.push_event_log(sample_log.back());
 
   // Get log file
   int log_id = 1;
@@ -198,7 +197,7 @@ TEST(BackEndApiTestSuite, postTest)
   BackendApi post_api_instance;
 
   // Push event
-  post_api_instance.push_event_log(sample_log);
+  post_api_instance.push_event_log(sample_log.back());
 
   // Get log file
   int log_id = 1;
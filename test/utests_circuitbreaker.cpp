@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <error_resolution_diagnoser/circuit_breaker.h>
+
+TEST(CircuitBreakerTestSuite, tripTest)
+{
+  // Create test object
+  CircuitBreaker breaker("Test API", 3, std::chrono::seconds(60), std::chrono::milliseconds(2000));
+
+  // Failures below the threshold keep the breaker closed
+  breaker.record_failure();
+  breaker.record_failure();
+  ASSERT_TRUE(breaker.allow());
+  ASSERT_EQ(breaker.get_state(), BreakerState::CLOSED);
+
+  // A success resets the count
+  breaker.record_success(std::chrono::milliseconds(10));
+  breaker.record_failure();
+  breaker.record_failure();
+  ASSERT_EQ(breaker.get_state(), BreakerState::CLOSED);
+
+  // Threshold reached, requests are rejected without being sent
+  breaker.record_failure();
+  ASSERT_EQ(breaker.get_state(), BreakerState::OPEN);
+  ASSERT_FALSE(breaker.allow());
+
+  BreakerStats stats = breaker.get_stats();
+  ASSERT_EQ(stats.trips, 1);
+  ASSERT_EQ(stats.rejected, 1);
+  ASSERT_EQ(stats.failures, 5);
+  ASSERT_EQ(stats.successes, 1);
+}
+
+TEST(CircuitBreakerTestSuite, probeTest)
+{
+  // Create test object with a short open time
+  CircuitBreaker breaker("Test API", 1, std::chrono::milliseconds(20), std::chrono::milliseconds(2000));
+  breaker.record_failure();
+  ASSERT_FALSE(breaker.allow());
+
+  // After the open time one probe is let through
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  ASSERT_TRUE(breaker.allow());
+  ASSERT_EQ(breaker.get_state(), BreakerState::HALF_OPEN);
+  ASSERT_FALSE(breaker.allow());
+
+  // Failed probe opens the breaker for twice as long
+  breaker.record_failure();
+  ASSERT_EQ(breaker.get_state(), BreakerState::OPEN);
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  ASSERT_FALSE(breaker.allow());
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_TRUE(breaker.allow());
+
+  // Successful probe closes it
+  breaker.record_success(std::chrono::milliseconds(10));
+  ASSERT_EQ(breaker.get_state(), BreakerState::CLOSED);
+  ASSERT_TRUE(breaker.allow());
+}
+
+TEST(CircuitBreakerTestSuite, timeoutTest)
+{
+  // Create test object
+  CircuitBreaker breaker("Test API", 5, std::chrono::seconds(60), std::chrono::milliseconds(2000));
+
+  // Maximum is used until enough response times are known
+  ASSERT_EQ(breaker.timeout(), std::chrono::milliseconds(2000));
+  for (int idx = 0; idx < 64; idx++)
+  {
+    breaker.record_success(std::chrono::milliseconds(100));
+  }
+  ASSERT_EQ(breaker.timeout(), std::chrono::milliseconds(400));
+
+  // Fast responses never go below a tenth of the maximum
+  for (int idx = 0; idx < 64; idx++)
+  {
+    breaker.record_success(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(breaker.timeout(), std::chrono::milliseconds(200));
+
+  // Failures widen the timeout up to the maximum
+  breaker.record_failure();
+  ASSERT_EQ(breaker.timeout(), std::chrono::milliseconds(400));
+  for (int idx = 0; idx < 3; idx++)
+  {
+    breaker.record_failure();
+  }
+  ASSERT_EQ(breaker.timeout(), std::chrono::milliseconds(2000));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <error_resolution_diagnoser/classification_artifact.h>
+#include <error_resolution_diagnoser/classification_index.h>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+// Sample table
+std::string robotModel = "Turtlebot3";
+std::string knownText = "Aborting because a valid plan could not be found. Even after executing all recovery behaviors";
+std::string warningText = "DWA Planner failed to produce path.";
+std::string sampleRows = "[{\"error_text\": \"" + knownText + "\", \"severity\": 8, \"compounding_flag\": false, \"error_module\": \"Navigation\", "
+                         "\"error_source\": \"/move_base\", \"robot_model\": \"Turtlebot3\"},"
+                         "{\"error_text\": \"" + warningText + "\", \"severity\": 4, \"compounding_flag\": true, \"error_module\": \"Navigation\", "
+                         "\"error_source\": \"/move_base\"}]";
+
+// Utility function to write a file
+std::string writeFile(const std::string &name, const std::string &contents)
+{
+  std::string path = testing::TempDir() + name;
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << contents;
+  out.close();
+  return path;
+}
+
+// Utility function to compile the sample table into an artifact
+std::string compileSample(const std::string &model)
+{
+  ClassificationIndex table;
+  std::string table_path = writeFile("ecs_table_unittest.json", sampleRows);
+  table.load(table_path, robotModel);
+  std::remove(table_path.c_str());
+  std::string path = testing::TempDir() + "ecs_table_unittest.bin";
+  EXPECT_TRUE(ClassificationArtifact::write(path, model, table.get_rows()));
+  return path;
+}
+
+TEST(ClassificationArtifactTestSuite, lookupTest)
+{
+  // Create test object
+  std::string path = compileSample(robotModel);
+  ClassificationArtifact artifact;
+  ASSERT_TRUE(ClassificationArtifact::is_artifact(path));
+  ASSERT_EQ(artifact.open(path, robotModel), 2);
+  ASSERT_EQ(artifact.size(), 2);
+
+  // Lookups return the same rows as the snapshot
+  json::value row;
+  ASSERT_TRUE(artifact.lookup(knownText, row));
+  ASSERT_EQ(row.at("severity").as_integer(), 8);
+  ASSERT_EQ(row.at("error_text").as_string(), knownText);
+  ASSERT_EQ(row.at("error_module").as_string(), "Navigation");
+  ASSERT_FALSE(row.at("compounding_flag").as_bool());
+  ASSERT_TRUE(artifact.lookup(warningText, row));
+  ASSERT_EQ(row.at("severity").as_integer(), 4);
+  ASSERT_FALSE(artifact.lookup("Got new plan", row));
+  ASSERT_FALSE(artifact.lookup("", row));
+  std::remove(path.c_str());
+}
+
+TEST(ClassificationArtifactTestSuite, sharedTest)
+{
+  // Several agents map the same artifact
+  std::string path = compileSample(robotModel);
+  ClassificationArtifact first;
+  ClassificationArtifact second;
+  ASSERT_EQ(first.open(path, robotModel), 2);
+  ASSERT_EQ(second.open(path, robotModel), 2);
+
+  // Mappings that are open stay valid when the file is removed or replaced
+  std::remove(path.c_str());
+  json::value row;
+  ASSERT_TRUE(first.lookup(knownText, row));
+  ASSERT_TRUE(second.lookup(warningText, row));
+}
+
+TEST(ClassificationArtifactTestSuite, indexTest)
+{
+  // Table snapshots set through ECS_TABLE_FILE may be artifacts
+  std::string path = compileSample(robotModel);
+  ClassificationIndex index;
+  ASSERT_EQ(index.load(path, robotModel), 2);
+  ASSERT_TRUE(index.is_mapped());
+  ASSERT_EQ(index.size(), 2);
+  json::value row;
+  ASSERT_TRUE(index.lookup(knownText, row));
+  ASSERT_FALSE(index.lookup("Got new plan", row));
+  std::remove(path.c_str());
+}
+
+TEST(ClassificationArtifactTestSuite, invalidTest)
+{
+  // Create test object
+  ClassificationArtifact artifact;
+  json::value row;
+
+  // Artifact of another robot model is not mapped
+  std::string path = compileSample("Other");
+  ASSERT_EQ(artifact.open(path, robotModel), 0);
+
+  // Truncated artifact is not mapped
+  std::ifstream in(path, std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  in.close();
+  path = writeFile("ecs_table_unittest.bin", contents.substr(0, contents.size() - 1));
+  ASSERT_EQ(artifact.open(path, robotModel), 0);
+
+  // Other format versions are not mapped
+  contents[8] = 2;
+  path = writeFile("ecs_table_unittest.bin", contents);
+  ASSERT_EQ(artifact.open(path, robotModel), 0);
+
+  // JSON snapshots and missing files are not artifacts
+  path = writeFile("ecs_table_unittest.bin", sampleRows);
+  ASSERT_FALSE(ClassificationArtifact::is_artifact(path));
+  ASSERT_EQ(artifact.open(path, robotModel), 0);
+  std::remove(path.c_str());
+  ASSERT_FALSE(ClassificationArtifact::is_artifact(path));
+  ASSERT_EQ(artifact.open(path, robotModel), 0);
+  ASSERT_FALSE(artifact.lookup(knownText, row));
+}
+
+TEST(ClassificationArtifactTestSuite, scalingTest)
+{
+  // Create a large table
+  std::unordered_map<std::string, json::value> rows;
+  for (int idx = 0; idx < 20000; idx++)
+  {
+    json::value row;
+    row["error_text"] = json::value::string("Error number " + std::to_string(idx));
+    row["severity"] = json::value::number(8);
+    rows["Error number " + std::to_string(idx)] = row;
+  }
+  std::string path = testing::TempDir() + "ecs_table_unittest.bin";
+  ASSERT_TRUE(ClassificationArtifact::write(path, robotModel, rows));
+  std::unordered_map<std::string, json::value> few_rows;
+  few_rows["Error number 0"] = rows["Error number 0"];
+  few_rows["Error number 1"] = rows["Error number 1"];
+  std::string few_path = testing::TempDir() + "ecs_table_few_unittest.bin";
+  ASSERT_TRUE(ClassificationArtifact::write(few_path, robotModel, few_rows));
+
+  // Opening only checks the header, so it takes about as long whatever the number of rows
+  const int opens = 200;
+  ClassificationArtifact artifact;
+  auto time_per_open = [&](const std::string &table_path) {
+    artifact.open(table_path, robotModel);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int idx = 0; idx < opens; idx++)
+    {
+      artifact.open(table_path, robotModel);
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / opens;
+  };
+  double few_us = time_per_open(few_path);
+  double open_us = time_per_open(path);
+  std::cout << "Artifact open: " << few_us << " us for 2 rows, " << open_us << " us for 20000 rows" << std::endl;
+  ASSERT_LT(open_us, (few_us * 5) + 20.0);
+  ASSERT_EQ(artifact.open(path, robotModel), 20000);
+  std::remove(few_path.c_str());
+
+  json::value row;
+  ASSERT_TRUE(artifact.lookup("Error number 12345", row));
+  ASSERT_EQ(row.at("error_text").as_string(), "Error number 12345");
+  ASSERT_FALSE(artifact.lookup("Error number 20000", row));
+  std::remove(path.c_str());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <fstream>
+#include <error_resolution_diagnoser/classification_cache.h>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+// Sample lookups
+std::string robotModel = "Turtlebot3";
+std::string knownText = "Aborting because a valid plan could not be found. Even after executing all recovery behaviors";
+std::string unknownText = "Got new plan";
+std::string apiConfig = "http://0.0.0.0:8000/ecs/error-data/|" + robotModel;
+
+TEST(ClassificationCacheTestSuite, hitMissTest)
+{
+  // Create test object
+  ClassificationCache cache(apiConfig, 16, std::chrono::seconds(60), std::chrono::seconds(60));
+  json::value value;
+
+  // Nothing cached yet
+  ASSERT_FALSE(cache.lookup(robotModel, knownText, value));
+
+  // Classification and "not in the table" answers are both served from the cache
+  cache.store(robotModel, knownText, json::value::string("Navigation"));
+  cache.store(robotModel, unknownText, json::value::null());
+  ASSERT_TRUE(cache.lookup(robotModel, knownText, value));
+  ASSERT_EQ(value.as_string(), "Navigation");
+  ASSERT_TRUE(cache.lookup(robotModel, unknownText, value));
+  ASSERT_TRUE(value.is_null());
+
+  // Same text for another robot model is a different lookup
+  ASSERT_FALSE(cache.lookup("Other", knownText, value));
+
+  ClassificationStats stats = cache.get_stats();
+  ASSERT_EQ(stats.entries, 2);
+  ASSERT_EQ(stats.hits, 1);
+  ASSERT_EQ(stats.negative, 1);
+  ASSERT_EQ(stats.misses, 2);
+}
+
+TEST(ClassificationCacheTestSuite, ttlTest)
+{
+  // Create test object, misses expire quickly
+  ClassificationCache cache(apiConfig, 16, std::chrono::seconds(60), std::chrono::milliseconds(20));
+  json::value value;
+
+  cache.store(robotModel, knownText, json::value::string("Navigation"));
+  cache.store(robotModel, unknownText, json::value::null());
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // Negative answer is queried again, the classification is still valid
+  ASSERT_FALSE(cache.lookup(robotModel, unknownText, value));
+  ASSERT_TRUE(cache.lookup(robotModel, knownText, value));
+  ASSERT_EQ(cache.get_stats().entries, 1);
+}
+
+TEST(ClassificationCacheTestSuite, lruTest)
+{
+  // Create test object
+  ClassificationCache cache(apiConfig, 2, std::chrono::seconds(60), std::chrono::seconds(60));
+  json::value value;
+
+  // Least recently used entry makes room
+  cache.store(robotModel, "first", json::value::null());
+  cache.store(robotModel, "second", json::value::null());
+  ASSERT_TRUE(cache.lookup(robotModel, "first", value));
+  cache.store(robotModel, "third", json::value::null());
+
+  ASSERT_TRUE(cache.lookup(robotModel, "first", value));
+  ASSERT_FALSE(cache.lookup(robotModel, "second", value));
+  ASSERT_TRUE(cache.lookup(robotModel, "third", value));
+  ASSERT_EQ(cache.get_stats().evictions, 1);
+}
+
+TEST(ClassificationCacheTestSuite, persistTest)
+{
+  // Create test object with one answer of each kind
+  std::string path = testing::TempDir() + "ecs_cache_unittest.bin";
+  ClassificationCache cache(apiConfig, 16, std::chrono::seconds(60), std::chrono::seconds(60));
+  json::value value;
+  cache.store(robotModel, knownText, json::value::string("Navigation"));
+  cache.store(robotModel, unknownText, json::value::null());
+  ASSERT_TRUE(cache.save(path));
+
+  // A new cache with the same configuration starts warm
+  ClassificationCache warm(apiConfig, 16, std::chrono::seconds(60), std::chrono::seconds(60));
+  ASSERT_EQ(warm.load(path), 2);
+  ASSERT_TRUE(warm.lookup(robotModel, knownText, value));
+  ASSERT_EQ(value.as_string(), "Navigation");
+  ASSERT_TRUE(warm.lookup(robotModel, unknownText, value));
+  ASSERT_TRUE(value.is_null());
+
+  // Another robot model or endpoint discards the file
+  ClassificationCache stale("http://0.0.0.0:8000/ecs/error-data/|Other", 16, std::chrono::seconds(60), std::chrono::seconds(60));
+  ASSERT_EQ(stale.load(path), 0);
+  ASSERT_EQ(stale.get_stats().entries, 0);
+
+  // A missing or corrupt file loads nothing
+  std::ofstream corrupt(path, std::ios::binary | std::ios::trunc);
+  corrupt << "not a cache";
+  corrupt.close();
+  ASSERT_EQ(warm.load(path), 0);
+  std::remove(path.c_str());
+  ASSERT_EQ(warm.load(path), 0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
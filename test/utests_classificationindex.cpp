@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <error_resolution_diagnoser/classification_index.h>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+// Sample table
+std::string robotModel = "Turtlebot3";
+std::string knownText = "Aborting because a valid plan could not be found. Even after executing all recovery behaviors";
+std::string warningText = "DWA Planner failed to produce path.";
+std::string otherModelText = "Arm joint limit reached";
+std::string sampleRows = "[{\"error_text\": \"" + knownText + "\", \"severity\": 8, \"compounding_flag\": false, \"error_module\": \"Navigation\", "
+                         "\"error_source\": \"/move_base\", \"robot_model\": \"Turtlebot3\"},"
+                         "{\"error_text\": \"" + otherModelText + "\", \"severity\": 8, \"compounding_flag\": false, \"error_module\": \"Manipulation\", "
+                         "\"error_source\": \"/arm_controller\", \"robot_model\": \"Other\"},"
+                         "{\"error_text\": \"" + warningText + "\", \"severity\": 4, \"compounding_flag\": true, \"error_module\": \"Navigation\", "
+                         "\"error_source\": \"/move_base\"},"
+                         "{\"severity\": 8}]";
+
+// Utility function to write a table snapshot
+std::string writeTable(const std::string &contents)
+{
+  std::string path = testing::TempDir() + "ecs_table_unittest.json";
+  std::ofstream out(path, std::ios::trunc);
+  out << contents;
+  out.close();
+  return path;
+}
+
+TEST(ClassificationIndexTestSuite, loadTest)
+{
+  // Create test object
+  ClassificationIndex index;
+  std::string path = writeTable(sampleRows);
+
+  // Rows of this robot model and rows for any model are indexed, the rest is skipped
+  ASSERT_EQ(index.load(path, robotModel), 2);
+  ASSERT_EQ(index.size(), 2);
+
+  // Lookups return the row with the fields the event log needs
+  json::value row;
+  ASSERT_TRUE(index.lookup(knownText, row));
+  ASSERT_EQ(row.at("severity").as_integer(), 8);
+  ASSERT_EQ(row.at("error_text").as_string(), knownText);
+  ASSERT_EQ(row.at("error_module").as_string(), "Navigation");
+  ASSERT_FALSE(row.at("compounding_flag").as_bool());
+  ASSERT_TRUE(index.lookup(warningText, row));
+  ASSERT_EQ(row.at("severity").as_integer(), 4);
+
+  // Texts not in the table or of another model are not classified
+  ASSERT_FALSE(index.lookup(otherModelText, row));
+  ASSERT_FALSE(index.lookup("Got new plan", row));
+  std::remove(path.c_str());
+}
+
+TEST(ClassificationIndexTestSuite, apiAnswerTest)
+{
+  // Create test object from a saved API answer
+  ClassificationIndex index;
+  std::string path = writeTable("{\"data\": " + sampleRows + "}");
+
+  json::value row;
+  ASSERT_EQ(index.load(path, robotModel), 2);
+  ASSERT_TRUE(index.lookup(knownText, row));
+  std::remove(path.c_str());
+}
+
+TEST(ClassificationIndexTestSuite, invalidTest)
+{
+  // Create test object
+  ClassificationIndex index;
+
+  // A missing, corrupt or row-less file loads nothing
+  std::string path = writeTable("not a table");
+  ASSERT_EQ(index.load(path, robotModel), 0);
+  path = writeTable("{\"data\": 42}");
+  ASSERT_EQ(index.load(path, robotModel), 0);
+  std::remove(path.c_str());
+  ASSERT_EQ(index.load(path, robotModel), 0);
+  ASSERT_EQ(index.size(), 0);
+}
+
+TEST(ClassificationIndexTestSuite, latencyTest)
+{
+  // Create test object
+  ClassificationIndex index;
+  std::string path = writeTable(sampleRows);
+  index.load(path, robotModel);
+  std::remove(path.c_str());
+
+  // Lookups stay in the microsecond range
+  const int lookups = 10000;
+  json::value row;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int idx = 0; idx < lookups; idx++)
+  {
+    index.lookup((idx % 2) ? knownText : "Got new plan", row);
+  }
+  double per_lookup_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / lookups;
+  std::cout << "Local classification: " << per_lookup_us << " us per lookup" << std::endl;
+  ASSERT_LT(per_lookup_us, 100.0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <error_resolution_diagnoser/http_client_pool.h>
+
+using namespace web::http::client; // HTTP client features
+
+// Sample host, no request is sent in these tests
+std::string host = "http://0.0.0.0:8000";
+
+TEST(HttpClientPoolTestSuite, reuseTest)
+{
+  // Create test object
+  HttpClientPool pool(host, http_client_config(), 2, std::chrono::seconds(60));
+
+  // A returned client is handed out again instead of creating a new one
+  http_client *first = nullptr;
+  {
+    std::shared_ptr<HttpClientPool::Lease> lease = pool.acquire();
+    first = &(lease->client());
+    ASSERT_EQ(pool.idle_count(), 0);
+  }
+  ASSERT_EQ(pool.idle_count(), 1);
+
+  std::shared_ptr<HttpClientPool::Lease> lease = pool.acquire();
+  ASSERT_EQ(&(lease->client()), first);
+  ASSERT_EQ(pool.created_count(), 1);
+}
+
+TEST(HttpClientPoolTestSuite, boundTest)
+{
+  // Create test object
+  HttpClientPool pool(host, http_client_config(), 2, std::chrono::seconds(60));
+
+  // Concurrent leases get distinct clients up to the bound
+  std::shared_ptr<HttpClientPool::Lease> lease1 = pool.acquire();
+  std::shared_ptr<HttpClientPool::Lease> lease2 = pool.acquire();
+  ASSERT_NE(&(lease1->client()), &(lease2->client()));
+  ASSERT_EQ(pool.open_count(), 2);
+
+  // A third caller waits until a client is returned
+  http_client *returned = &(lease1->client());
+  http_client *third = nullptr;
+  std::thread waiter([&]() {
+    std::shared_ptr<HttpClientPool::Lease> lease3 = pool.acquire();
+    third = &(lease3->client());
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  lease1.reset();
+  waiter.join();
+
+  ASSERT_EQ(third, returned);
+  ASSERT_EQ(pool.created_count(), 2);
+}
+
+TEST(HttpClientPoolTestSuite, discardTest)
+{
+  // Create test object
+  HttpClientPool pool(host, http_client_config(), 2, std::chrono::seconds(60));
+
+  // A client marked broken is dropped, the next lease gets a fresh one
+  {
+    std::shared_ptr<HttpClientPool::Lease> lease = pool.acquire();
+    lease->discard();
+  }
+  ASSERT_EQ(pool.idle_count(), 0);
+  ASSERT_EQ(pool.open_count(), 0);
+  ASSERT_EQ(pool.discarded_count(), 1);
+
+  pool.acquire();
+  ASSERT_EQ(pool.created_count(), 2);
+}
+
+TEST(HttpClientPoolTestSuite, reapTest)
+{
+  // Create test object with a short idle timeout
+  HttpClientPool pool(host, http_client_config(), 2, std::chrono::milliseconds(20));
+
+  // Idle clients are closed once past the timeout
+  pool.acquire();
+  ASSERT_EQ(pool.idle_count(), 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  pool.reap_idle();
+  ASSERT_EQ(pool.idle_count(), 0);
+  ASSERT_EQ(pool.open_count(), 0);
+}
+
+TEST(HttpClientPoolTestSuite, timeoutTest)
+{
+  // Create test object
+  HttpClientPool pool(host, http_client_config(), 2, std::chrono::seconds(60));
+  std::shared_ptr<HttpClientPool::Lease> lease = pool.acquire();
+  pool.acquire();
+  ASSERT_EQ(pool.idle_count(), 1);
+
+  // A new timeout closes idle clients and drops the leased one when it comes back
+  pool.set_timeout(std::chrono::milliseconds(500));
+  ASSERT_EQ(pool.get_timeout(), std::chrono::milliseconds(500));
+  ASSERT_EQ(pool.idle_count(), 0);
+  lease.reset();
+  ASSERT_EQ(pool.idle_count(), 0);
+  ASSERT_EQ(pool.open_count(), 0);
+  ASSERT_EQ(pool.discarded_count(), 0);
+}
+
+TEST(HttpClientPoolTestSuite, asyncTest)
+{
+  // Create test object
+  HttpClientPool pool(host, http_client_config(), 1, std::chrono::seconds(60));
+
+  // Lease is ready right away while a client is free
+  pplx::task<std::shared_ptr<HttpClientPool::Lease>> first = pool.acquire_async();
+  ASSERT_TRUE(first.is_done());
+  std::shared_ptr<HttpClientPool::Lease> lease = first.get();
+  http_client *returned = &(lease->client());
+  first = pplx::task<std::shared_ptr<HttpClientPool::Lease>>(); // The task keeps a copy of its result
+
+  // An exhausted pool parks the caller until the client comes back
+  pplx::task<std::shared_ptr<HttpClientPool::Lease>> second = pool.acquire_async();
+  ASSERT_FALSE(second.is_done());
+  lease.reset();
+  ASSERT_EQ(&(second.get()->client()), returned);
+  ASSERT_EQ(pool.created_count(), 1);
+}
+
+TEST(HttpClientPoolTestSuite, asyncBacklogTest)
+{
+  // Create test object with far fewer clients than callers
+  HttpClientPool pool(host, http_client_config(), 2, std::chrono::seconds(60));
+
+  // Every caller holds its lease in a continuation and then returns it. Waiting callers hold no thread,
+  // so the backlog drains even when it is far larger than the task thread pool.
+  std::atomic<int> served(0);
+  std::vector<pplx::task<void>> lookups;
+  for (int idx = 0; idx < 500; idx++)
+  {
+    lookups.push_back(pool.acquire_async().then([&served](std::shared_ptr<HttpClientPool::Lease> lease) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      served++;
+    }));
+  }
+  pplx::when_all(lookups.begin(), lookups.end()).wait();
+
+  ASSERT_EQ(served.load(), 500);
+  ASSERT_EQ(pool.created_count(), 2);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <cpprest/json.h>
+#undef U
+#include <error_resolution_diagnoser/json_writer.h>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+// Sample text with every kind of character that needs escaping
+std::string sampleText = std::string("Path \"C:\\maps\"\tline\nnext\r\b\f end ") + char(0x01) + char(0x1F) + " /move_base caf\xc3\xa9";
+
+// Number of payloads in the benchmark
+const int payload_count = 10000;
+
+// Event payload written the old way
+std::string cpprestPayload(const std::string &message, double value)
+{
+  json::value payload = json::value::object();
+  payload[utility::conversions::to_string_t("agent_id")] = json::value::string(utility::conversions::to_string_t("Sample agent"));
+  payload[utility::conversions::to_string_t("robot_id")] = json::value::string(utility::conversions::to_string_t("Sample robot"));
+  payload[utility::conversions::to_string_t("message")] = json::value::string(utility::conversions::to_string_t(message));
+  payload[utility::conversions::to_string_t("compounding")] = json::value::boolean(false);
+  payload[utility::conversions::to_string_t("create_ticket")] = json::value::boolean(true);
+  payload[utility::conversions::to_string_t("value")] = json::value::number(value);
+  payload[utility::conversions::to_string_t("telemetry")] = json::value::null();
+  return payload.serialize();
+}
+
+// Same payload streamed
+const std::string &writerPayload(JsonWriter &writer, const std::string &message, double value)
+{
+  writer.clear();
+  writer.begin_object();
+  writer.key("agent_id");
+  writer.string("Sample agent");
+  writer.key("compounding");
+  writer.boolean(false);
+  writer.key("create_ticket");
+  writer.boolean(true);
+  writer.key("message");
+  writer.string(message);
+  writer.key("robot_id");
+  writer.string("Sample robot");
+  writer.key("telemetry");
+  writer.null();
+  writer.key("value");
+  writer.number(value);
+  writer.end_object();
+  return writer.str();
+}
+
+TEST(JsonWriterTestSuite, escapeTest)
+{
+  // Create test object
+  JsonWriter writer;
+
+  // Escapes match cpprest, other bytes pass through
+  writer.string(sampleText);
+  ASSERT_EQ(writer.str(), json::value::string(sampleText).serialize());
+  ASSERT_EQ(writer.str(), "\"Path \\\"C:\\\\maps\\\"\\tline\\nnext\\r\\b\\f end \\u0001\\u001F /move_base caf\xc3\xa9\"");
+}
+
+TEST(JsonWriterTestSuite, numberTest)
+{
+  // Create test object
+  JsonWriter writer;
+
+  // Doubles keep cpprest's digits
+  double values[] = {0.0, 2.0, -1.5, 0.1, 1.0 / 3.0, 1e-20, 6.02214076e23};
+  for (double value : values)
+  {
+    writer.clear();
+    writer.number(value);
+    ASSERT_EQ(writer.str(), json::value::number(value).serialize());
+  }
+}
+
+TEST(JsonWriterTestSuite, structureTest)
+{
+  // Create test object
+  JsonWriter writer;
+
+  // Commas only between members, nested objects and raw values included
+  writer.begin_object();
+  writer.key("a");
+  writer.begin_object();
+  writer.end_object();
+  writer.key("b");
+  writer.begin_object();
+  writer.key("c");
+  writer.null();
+  writer.key("d");
+  writer.raw("{\"pose\":42}");
+  writer.end_object();
+  writer.key("e");
+  writer.boolean(false);
+  writer.end_object();
+  ASSERT_EQ(writer.str(), "{\"a\":{},\"b\":{\"c\":null,\"d\":{\"pose\":42}},\"e\":false}");
+
+  // Clearing starts a new document
+  writer.clear();
+  writer.begin_object();
+  writer.end_object();
+  ASSERT_EQ(writer.str(), "{}");
+}
+
+TEST(JsonWriterTestSuite, payloadBenchmarkTest)
+{
+  // Output is byte compatible with the object tree it replaces
+  JsonWriter writer;
+  ASSERT_EQ(writerPayload(writer, sampleText, 0.1), cpprestPayload(sampleText, 0.1));
+
+  // Compare building and serializing an object tree against streaming into a reused buffer
+  std::string message = "Aborting because a valid control could not be found. Even after executing all recovery behaviors";
+  size_t total = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int idx = 0; idx < payload_count; idx++)
+  {
+    total += cpprestPayload(message, idx).size();
+  }
+  double cpprest_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (int idx = 0; idx < payload_count; idx++)
+  {
+    total -= writerPayload(writer, message, idx).size();
+  }
+  double writer_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << payload_count << " payloads: json::value " << cpprest_us << " us, JsonWriter " << writer_us << " us" << std::endl;
+
+  // Same bytes were produced, timings vary between machines so only check the writer is not slower
+  ASSERT_EQ(total, 0u);
+  ASSERT_LT(writer_us, cpprest_us);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <error_resolution_diagnoser/log_template_miner.h>
+
+// Sample messages that change on every occurrence
+std::string trajectoryMessage1 = "Invalid Trajectory 0.000000, 0.000000, -0.400000, cost: -6.000000";
+std::string trajectoryMessage2 = "Invalid Trajectory 0.100000, 0.000000, 0.400000, cost: -4.500000";
+std::string costmapMessage1 = "Clearing both costmaps to unstuck robot (1.84m).";
+std::string costmapMessage2 = "Clearing both costmaps to unstuck robot (3.00m).";
+
+TEST(LogTemplateMinerTestSuite, numericVariantTest)
+{
+  // Create test object
+  LogTemplateMiner miner;
+
+  // Numeric variants map to the same template
+  uint64_t trajectoryId = miner.add_message(trajectoryMessage1);
+  ASSERT_EQ(miner.add_message(trajectoryMessage2), trajectoryId);
+
+  uint64_t costmapId = miner.add_message(costmapMessage1);
+  ASSERT_EQ(miner.add_message(costmapMessage2), costmapId);
+
+  // Different messages get different templates
+  ASSERT_NE(trajectoryId, costmapId);
+  ASSERT_EQ(miner.size(), 2);
+
+  // Numbers are masked in the template text
+  ASSERT_EQ(miner.get_template(trajectoryId), "Invalid Trajectory <*> <*> <*> cost: <*>");
+  ASSERT_EQ(miner.get_template(costmapId), "Clearing both costmaps to unstuck robot <*>");
+}
+
+TEST(LogTemplateMinerTestSuite, constantWordTest)
+{
+  // Create test object
+  LogTemplateMiner miner;
+
+  // Words without digits are never generalized, so messages that differ in wording keep their own templates
+  uint64_t reachedId = miner.add_message("Goal reached");
+  uint64_t abortedId = miner.add_message("Goal aborted");
+  ASSERT_NE(reachedId, abortedId);
+  ASSERT_EQ(miner.get_template(reachedId), "Goal reached");
+  ASSERT_EQ(miner.get_template(abortedId), "Goal aborted");
+  uint64_t collisionId = miner.add_message("Rotation cmd in collision");
+  ASSERT_NE(miner.add_message("Rotation cmd in limits"), collisionId);
+  ASSERT_EQ(miner.add_message("Rotation cmd in collision"), collisionId);
+
+  // Messages of another length start new templates
+  ASSERT_NE(miner.add_message("Goal reached again"), reachedId);
+  ASSERT_EQ(miner.size(), 5);
+}
+
+TEST(LogTemplateMinerTestSuite, unknownIdTest)
+{
+  // Create test object
+  LogTemplateMiner miner;
+
+  // Unknown IDs have no template
+  ASSERT_TRUE(miner.get_template(0).empty());
+  ASSERT_TRUE(miner.get_template(1).empty());
+
+  // Clearing forgets every template
+  miner.add_message("Got new plan");
+  ASSERT_EQ(miner.get_template(1), "Got new plan");
+  miner.clear();
+  ASSERT_EQ(miner.size(), 0);
+}
+
+TEST(LogTemplateMinerTestSuite, limitTest)
+{
+  // Create test object with room for two templates
+  LogTemplateMiner miner;
+  miner.set_limits(2, 0);
+
+  uint64_t trajectoryId = miner.add_message(trajectoryMessage1);
+  uint64_t costmapId = miner.add_message(costmapMessage1);
+
+  // Matching keeps a template recent, the least recently matched one is evicted with its branch
+  ASSERT_EQ(miner.add_message(trajectoryMessage2), trajectoryId);
+  uint64_t planId = miner.add_message("Got new plan");
+  StateUsage usage = miner.usage();
+  ASSERT_EQ(usage.entries, 2);
+  ASSERT_EQ(usage.evictions, 1);
+  ASSERT_TRUE(miner.get_template(costmapId).empty());
+  ASSERT_EQ(miner.get_template(trajectoryId), "Invalid Trajectory <*> <*> <*> cost: <*>");
+  ASSERT_EQ(miner.get_template(planId), "Got new plan");
+
+  // Evicted messages come back under a new ID
+  ASSERT_NE(miner.add_message(costmapMessage2), costmapId);
+}
+
+TEST(LogTemplateMinerTestSuite, uniqueMessageTest)
+{
+  // Create test object with an entry ceiling
+  LogTemplateMiner miner;
+  miner.set_limits(100, 0);
+  miner.add_message("Got new plan");
+  size_t baseline = miner.usage().bytes;
+
+  // A stream of unique messages stays within the ceiling, tree included
+  for (int idx = 0; idx < 10000; idx++)
+  {
+    // Letters only, so nothing is masked as a number
+    std::string word = {static_cast<char>('a' + (idx % 26)), static_cast<char>('a' + ((idx / 26) % 26)), static_cast<char>('a' + (idx / 676))};
+    miner.add_message("Node" + word + " lost " + word + " link");
+  }
+  StateUsage usage = miner.usage();
+  ASSERT_EQ(usage.entries, 100);
+  ASSERT_GT(usage.evictions, 0);
+  ASSERT_LT(usage.bytes, baseline * 100 * 4);
+
+  // Byte ceiling applies too, evicting every template prunes the whole tree
+  miner.set_limits(0, 1);
+  ASSERT_EQ(miner.size(), 0);
+  ASSERT_EQ(miner.usage().bytes, 0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
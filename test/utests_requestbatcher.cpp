@@ -0,0 +1,164 @@
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <cpprest/http_listener.h>
+#undef U
+#include <error_resolution_diagnoser/backend_api.h>
+
+using namespace web;                          // Common features like URIs.
+using namespace web::http;                    // Common HTTP functionality
+using namespace web::http::experimental::listener; // HTTP listener features
+using namespace web::json;                    // JSON features
+
+// Sample lookups
+std::string knownText = "Aborting because a valid plan could not be found. Even after executing all recovery behaviors";
+std::string unknownText = "Got new plan";
+std::string otherText = "Clearing costmap to unstuck robot";
+
+// Utility function that answers every text with its position in the batch
+RequestBatcher::SendFunction echoSend(std::atomic<int> &calls)
+{
+  return [&calls](const std::vector<std::string> &texts) {
+    calls++;
+    std::vector<json::value> results;
+    for (size_t idx = 0; idx < texts.size(); idx++)
+    {
+      results.push_back(json::value::string(texts[idx] + "#" + std::to_string(idx)));
+    }
+    return pplx::task_from_result(results);
+  };
+}
+
+TEST(RequestBatcherTestSuite, sizeTest)
+{
+  // Create test object that would linger for long
+  std::atomic<int> calls(0);
+  RequestBatcher batcher(3, std::chrono::seconds(10), echoSend(calls));
+
+  // A full batch is sent without waiting and results go back to their own text
+  pplx::task<json::value> first = batcher.submit("first");
+  pplx::task<json::value> second = batcher.submit("second");
+  pplx::task<json::value> third = batcher.submit("third");
+  ASSERT_EQ(first.get().as_string(), "first#0");
+  ASSERT_EQ(second.get().as_string(), "second#1");
+  ASSERT_EQ(third.get().as_string(), "third#2");
+  ASSERT_EQ(calls, 1);
+  ASSERT_EQ(batcher.batch_count(), 1);
+  ASSERT_EQ(batcher.text_count(), 3);
+}
+
+TEST(RequestBatcherTestSuite, lingerTest)
+{
+  // Create test object
+  std::atomic<int> calls(0);
+  RequestBatcher batcher(10, std::chrono::milliseconds(20), echoSend(calls));
+
+  // A batch that never fills is sent once the oldest text has lingered
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  pplx::task<json::value> first = batcher.submit("first");
+  pplx::task<json::value> second = batcher.submit("second");
+  ASSERT_EQ(second.get().as_string(), "second#1");
+  ASSERT_EQ(first.get().as_string(), "first#0");
+  ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+  ASSERT_EQ(calls, 1);
+}
+
+TEST(RequestBatcherTestSuite, errorTest)
+{
+  // Create test object whose requests fail
+  RequestBatcher batcher(2, std::chrono::milliseconds(20), [](const std::vector<std::string> &texts) {
+    return pplx::task_from_exception<std::vector<json::value>>(std::runtime_error("batch failed"));
+  });
+
+  // Every text of the batch sees the failure
+  pplx::task<json::value> first = batcher.submit("first");
+  pplx::task<json::value> second = batcher.submit("second");
+  ASSERT_THROW(first.get(), std::runtime_error);
+  ASSERT_THROW(second.get(), std::runtime_error);
+}
+
+TEST(RequestBatcherTestSuite, standInServerTest)
+{
+  // Stand-in ECS API implementing the batch contract: texts in, one data array per text out in the same order
+  std::atomic<int> requests(0);
+  std::atomic<size_t> last_batch(0);
+  http_listener listener("http://127.0.0.1:8765/ecs/error-data/batch/");
+  listener.support(methods::POST, [&](http_request request) {
+    json::value body = request.extract_json().get();
+    json::array &texts = body.at("ErrorTexts").as_array();
+    json::value data = json::value::array(texts.size());
+    for (size_t idx = 0; idx < texts.size(); idx++)
+    {
+      data[idx] = json::value::array();
+      if (texts.at(idx).as_string() == knownText)
+      {
+        json::value classification;
+        classification["error_text"] = json::value::string(knownText);
+        classification["severity"] = json::value::number(8);
+        data[idx][0] = classification;
+      }
+    }
+    json::value reply;
+    reply["data"] = data;
+    requests++;
+    last_batch = texts.size();
+    request.reply(status_codes::OK, reply);
+  });
+  listener.open().wait();
+
+  // Set mode to ECS with batching, starting from an empty cache
+  static char agent_type[50] = "AGENT_TYPE=ECS";
+  static char ecs_api[200] = "ECS_API=http://127.0.0.1:8765";
+  static char ecs_robot_model[200] = "ECS_ROBOT_MODEL=Turtlebot3";
+  static char ecs_batch_size[50] = "ECS_BATCH_SIZE=8";
+  static char ecs_batch_linger[50] = "ECS_BATCH_LINGER_MS=50";
+  putenv(agent_type);
+  putenv(ecs_api);
+  putenv(ecs_robot_model);
+  putenv(ecs_batch_size);
+  std::string cache_file = testing::TempDir() + "ecs_cache_batcher_unittest.bin";
+  static char ecs_cache_file[200];
+  snprintf(ecs_cache_file, sizeof(ecs_cache_file), "ECS_CACHE_FILE=%s", cache_file.c_str());
+  putenv(ecs_batch_linger);
+  putenv(ecs_cache_file);
+  std::remove(cache_file.c_str());
+
+  {
+    // Create test object
+    BackendApi api;
+    ASSERT_NE(api.get_ecs_batcher(), nullptr);
+
+    // Lookups made together go out in one request and each gets its own answer
+    pplx::task<json::value> known = api.classify_async(knownText);
+    pplx::task<json::value> unknown = api.classify_async(unknownText);
+    pplx::task<json::value> other = api.classify_async(otherText);
+    ASSERT_EQ(known.get().at("error_text").as_string(), knownText);
+    ASSERT_TRUE(unknown.get().is_null());
+    ASSERT_TRUE(other.get().is_null());
+    ASSERT_EQ(requests, 1);
+    ASSERT_EQ(last_batch, 3);
+
+    // Answers are cached like single queries
+    ASSERT_EQ(api.check_error_classification(knownText).at("error_text").as_string(), knownText);
+    ASSERT_EQ(requests, 1);
+  }
+
+  listener.close().wait();
+  std::remove(cache_file.c_str());
+  unsetenv("ECS_BATCH_SIZE");
+  unsetenv("ECS_BATCH_LINGER_MS");
+  unsetenv("ECS_CACHE_FILE");
+  unsetenv("AGENT_TYPE");
+  unsetenv("ECS_API");
+  unsetenv("ECS_ROBOT_MODEL");
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,6 +1,7 @@
 #include <ros/ros.h>
 #include <gtest/gtest.h>
 #include <fstream>
+#include <type_traits>
 #include <error_resolution_diagnoser/robot_event.h>
 
 using namespace web::json; // JSON features
@@ -10,9 +11,6 @@ using namespace web;       // Common features like URIs.
 RobotEvent event_instance;
 
 // Create sample log
-std::vector<std::vector<std::string>> sample_log;
-std::string level = "8";
-std::string cflag = "Null";
 std::string module = "Null";
 std::string source = "/move_base";
 std::string message = "Aborting because a valid control could not be found. Even after executing all recovery behaviors";
@@ -20,9 +18,6 @@ std::string description = "Null";
 std::string resolution = "Null";
 std::string telemetry_str = "{\"pose\":42}";
 
-// Hold the record
-std::vector<std::string> event_details;
-
 TEST(RobotEventTestSuite, getLogTest)
 {
   // Sample message
@@ -37,8 +32,7 @@ TEST(RobotEventTestSuite, getLogTest)
   json::value telemetry = json::value::null();
 
   // Declare log variable
-  std::vector<std::vector<std::string>> updatedLog;
-  std::vector<std::string> currentRow;
+  std::vector<EventRecord> updatedLog;
 
   // Update log
   event_instance.update_log(rosmsg, msgInfo, telemetry, "ROS");
@@ -50,10 +44,14 @@ TEST(RobotEventTestSuite, getLogTest)
   // Check if there is only one row
   ASSERT_EQ(updatedLog.size(), 1);
 
-  // Check if there are 10 elements in that one row
-  int expElements = 10;
-  currentRow = updatedLog[0];
-  ASSERT_EQ(currentRow.size(), expElements);
+  // Check if the row is stamped with an event id and telemetry
+  ASSERT_NE(updatedLog[0].event_id, nullptr);
+  ASSERT_NE(updatedLog[0].telemetry, nullptr);
+
+  // Log is handed out as a view of the event's own records, not a copy
+  static_assert(std::is_reference<decltype(event_instance.get_log())>::value, "get_log returns a reference");
+  const std::vector<EventRecord> &logView = event_instance.get_log();
+  ASSERT_EQ(logView.back().event_id, updatedLog[0].event_id);
 
   // Clear event
   event_instance.clear();
@@ -72,8 +70,7 @@ TEST(RobotEventTestSuite, updateLogROSTest)
   json::value msgInfo = json::value::null();
 
   // Declare log variable
-  std::vector<std::vector<std::string>> updatedLog;
-  std::vector<std::string> currentRow;
+  std::vector<EventRecord> updatedLog;
 
   // For testing, telemetry is set to a constant
   json::value telemetry = json::value::parse(telemetry_str);
@@ -81,32 +78,24 @@ TEST(RobotEventTestSuite, updateLogROSTest)
   // Update log
   event_instance.update_log(rosmsg, msgInfo, telemetry, "ROS");
 
-  // Expected log
-  // For ROS, cflag is Null
-  cflag = "Null";
-  event_details.push_back(level);
-  event_details.push_back(cflag);
-  event_details.push_back(module);
-  event_details.push_back(source);
-  event_details.push_back(message);
-  event_details.push_back(description);
-  event_details.push_back(resolution);
-  event_details.push_back(telemetry_str);
-
   // Get log
   updatedLog = event_instance.get_log();
-  currentRow = updatedLog[0];
+  const EventRecord &currentRow = updatedLog[0];
 
   // Check if content is equal
-  for (int idx = 1; idx < currentRow.size() - 1; idx++)
-  {
-    ASSERT_EQ(event_details[idx - 1], currentRow[idx]);
-  }
+  // For ROS, cflag is Null
+  ASSERT_EQ(currentRow.level, EventLevel::ERROR);
+  ASSERT_EQ(currentRow.compounding, Compounding::UNSET);
+  ASSERT_EQ(currentRow.compounding_str(), "Null");
+  ASSERT_EQ(*(currentRow.module), module);
+  ASSERT_EQ(*(currentRow.source), source);
+  ASSERT_EQ(currentRow.message, message);
+  ASSERT_EQ(currentRow.description, description);
+  ASSERT_EQ(currentRow.resolution, resolution);
+  ASSERT_EQ(*(currentRow.telemetry), telemetry_str);
 
   // Clear event
   event_instance.clear();
-  // Clear expected log
-  event_details.clear();
 }
 
 TEST(RobotEventTestSuite, updateLogDBTest)
@@ -120,20 +109,9 @@ TEST(RobotEventTestSuite, updateLogDBTest)
 
   // For DB test, need for ECS, manually construct an ECS response so we don't rely on ECS connection
   json::value msgInfo = json::value::object();
-  // For DB, cflag is NOT Null
-  cflag = "true";
-  event_details.push_back(std::to_string(8));
-  event_details.push_back(cflag);
-  event_details.push_back("Navigation");
-  event_details.push_back(source);
-  event_details.push_back(message);
-  event_details.push_back("The robot is unable to move around. This usually means the robot is mislocalized or there is an obstacle.");
-  event_details.push_back("Relocalize the robot using intervention, assign a sample goal. If that does not work, use teleoperation to nudge the robot from the impossible position. If that does not work, escalate to property.");
-  event_details.push_back(telemetry_str);
 
   // Declare log variable
-  std::vector<std::vector<std::string>> updatedLog;
-  std::vector<std::string> currentRow;
+  std::vector<EventRecord> updatedLog;
 
   // Create keys
   utility::string_t codeKey(utility::conversions::to_string_t("error_code"));
@@ -163,18 +141,24 @@ TEST(RobotEventTestSuite, updateLogDBTest)
 
   // Get log
   updatedLog = event_instance.get_log();
-  currentRow = updatedLog[0];
+  const EventRecord &currentRow = updatedLog[0];
 
   // Check if content is equal
-  for (int idx = 1; idx < currentRow.size() - 2; idx++)
-  {
-    ASSERT_EQ(event_details[idx - 1], currentRow[idx]);
-  }
+  // For DB, cflag is NOT Null
+  ASSERT_EQ(currentRow.level, EventLevel::ERROR);
+  ASSERT_EQ(currentRow.compounding, Compounding::YES);
+  ASSERT_EQ(currentRow.compounding_str(), "true");
+  ASSERT_EQ(*(currentRow.module), "Navigation");
+  ASSERT_EQ(*(currentRow.source), source);
+  ASSERT_EQ(currentRow.message, message);
+  ASSERT_EQ(currentRow.description, "The robot is unable to move around. This usually means the robot is mislocalized or there is an obstacle.");
+  ASSERT_EQ(currentRow.resolution, "Relocalize the robot using intervention, assign a sample goal. If that does not work, use teleoperation to nudge the robot from the impossible position. If that does not work, escalate to property.");
+
+  // Compounding errors do not create a ticket
+  ASSERT_FALSE(currentRow.creates_ticket());
 
   // Clear event
   event_instance.clear();
-  // Clear expected log
-  event_details.clear();
 }
 
 TEST(RobotEventTestSuite, updateLogECSTest)
@@ -188,20 +172,9 @@ TEST(RobotEventTestSuite, updateLogECSTest)
 
   // For DB test, need for ECS, manually construct an ECS response so we don't rely on ECS connection
   json::value msgInfo = json::value::object();
-  // For DB, cflag is NOT Null
-  cflag = "false";
-  event_details.push_back(std::to_string(16));
-  event_details.push_back(cflag);
-  event_details.push_back("Navigation");
-  event_details.push_back(source);
-  event_details.push_back(message);
-  event_details.push_back(message);
-  event_details.push_back("Null");
-  event_details.push_back(telemetry_str);
 
   // Declare log variable
-  std::vector<std::vector<std::string>> updatedLog;
-  std::vector<std::string> currentRow;
+  std::vector<EventRecord> updatedLog;
 
   // Create keys
   utility::string_t codeKey(utility::conversions::to_string_t("cognicept_error_code"));
@@ -227,18 +200,24 @@ TEST(RobotEventTestSuite, updateLogECSTest)
 
   // Get log
   updatedLog = event_instance.get_log();
-  currentRow = updatedLog[0];
+  const EventRecord &currentRow = updatedLog[0];
 
   // Check if content is equal
-  for (int idx = 1; idx < currentRow.size() - 2; idx++)
-  {
-    ASSERT_EQ(event_details[idx-1], currentRow[idx]);
-  }
+  // For ECS, cflag is NOT Null and description is the error text
+  ASSERT_EQ(currentRow.level, EventLevel::FATAL);
+  ASSERT_EQ(currentRow.compounding, Compounding::NO);
+  ASSERT_EQ(currentRow.compounding_str(), "false");
+  ASSERT_EQ(*(currentRow.module), "Navigation");
+  ASSERT_EQ(*(currentRow.source), source);
+  ASSERT_EQ(currentRow.message, message);
+  ASSERT_EQ(currentRow.description, message);
+  ASSERT_EQ(currentRow.resolution, "Null");
+
+  // Non compounding fatal errors create a ticket
+  ASSERT_TRUE(currentRow.creates_ticket());
 
   // Clear event
   event_instance.clear();
-  // Clear expected log
-  event_details.clear();
 }
 
 TEST(RobotEventTestSuite, updateEventIdTest)
@@ -257,8 +236,7 @@ TEST(RobotEventTestSuite, updateEventIdTest)
   json::value telemetry = json::value::null();
 
   // Declare log variable
-  std::vector<std::vector<std::string>> updatedLog;
-  std::vector<std::string> currentRow;
+  std::vector<EventRecord> updatedLog;
 
   // Update log
   event_instance.update_log(rosmsg, msgInfo, telemetry, "ROS");
@@ -267,8 +245,7 @@ TEST(RobotEventTestSuite, updateEventIdTest)
   updatedLog = event_instance.get_log();
 
   // Get event id value
-  currentRow = updatedLog[0];
-  std::string eventId1 = currentRow.back();
+  std::string eventId1 = *(updatedLog[0].event_id);
 
   // Clear LOG and Update log again, this should result in same event id
   event_instance.clear_log();
@@ -278,8 +255,7 @@ TEST(RobotEventTestSuite, updateEventIdTest)
   updatedLog = event_instance.get_log();
 
   // Get event id value
-  currentRow = updatedLog[0];
-  std::string eventId2 = currentRow.back();
+  std::string eventId2 = *(updatedLog[0].event_id);
 
   // Clear EVENT and Update log again, this should result in a different event id
   event_instance.clear();
@@ -289,8 +265,7 @@ TEST(RobotEventTestSuite, updateEventIdTest)
   updatedLog = event_instance.get_log();
 
   // Get event id value
-  currentRow = updatedLog[0];
-  std::string eventId3 = currentRow.back();
+  std::string eventId3 = *(updatedLog[0].event_id);
 
   // Check if even ids 1 and 2 are equal
   ASSERT_EQ(eventId1, eventId2);
@@ -315,8 +290,7 @@ TEST(RobotEventTestSuite, clearTest)
   json::value msgInfo = json::value::null();
 
   // Declare log variable
-  std::vector<std::vector<std::string>> updatedLog;
-  std::vector<std::string> currentRow;
+  std::vector<EventRecord> updatedLog;
 
   // For testing, telemetry can be null
   json::value telemetry = json::value::null();
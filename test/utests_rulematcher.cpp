@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <error_resolution_diagnoser/rule_matcher.h>
+
+// Sample messages
+std::string collisionText = "Rotation cmd in collision";
+std::string clearingText = "Clearing both costmaps to unstuck robot (3.00m).";
+std::string planText = "Got new plan";
+
+TEST(RuleMatcherTestSuite, literalTest)
+{
+  // Create test object
+  RuleMatcher matcher;
+  uint32_t contains = matcher.add_rule("in collision", RuleKind::CONTAINS);
+  uint32_t prefix = matcher.add_rule("Clearing both costmaps", RuleKind::PREFIX);
+  uint32_t suffix = matcher.add_rule("new plan", RuleKind::SUFFIX);
+  uint32_t exact = matcher.add_rule("Goal reached", RuleKind::EXACT);
+  matcher.compile();
+
+  // Each kind only matches where it is anchored
+  ASSERT_EQ(matcher.match(collisionText), contains);
+  ASSERT_EQ(matcher.match(clearingText), prefix);
+  ASSERT_EQ(matcher.match("Not Clearing both costmaps"), -1);
+  ASSERT_EQ(matcher.match(planText), suffix);
+  ASSERT_EQ(matcher.match("Got new plan again"), -1);
+  ASSERT_EQ(matcher.match("Goal reached"), exact);
+  ASSERT_EQ(matcher.match("Goal reached twice"), -1);
+  ASSERT_EQ(matcher.match(""), -1);
+}
+
+TEST(RuleMatcherTestSuite, overlapTest)
+{
+  // Create test object with patterns that overlap and share suffixes
+  RuleMatcher matcher;
+  matcher.add_rule("costmaps to unstuck", RuleKind::CONTAINS);
+  uint32_t unstuck = matcher.add_rule("unstuck", RuleKind::CONTAINS);
+  uint32_t maps = matcher.add_rule("maps", RuleKind::CONTAINS);
+  matcher.compile();
+
+  // First added rule wins, found through failure links
+  ASSERT_EQ(matcher.match(clearingText), 0);
+  ASSERT_EQ(matcher.match("robot is unstuck"), unstuck);
+  ASSERT_EQ(matcher.match("costmaps to unstu"), maps);
+  ASSERT_EQ(matcher.match("cost"), -1);
+}
+
+TEST(RuleMatcherTestSuite, globTest)
+{
+  // Create test object
+  RuleMatcher matcher;
+  uint32_t literal = matcher.add_rule("Goal reached", RuleKind::EXACT);
+  uint32_t clearing = matcher.add_rule("Clearing * costmaps*(?.??m).", RuleKind::GLOB);
+  uint32_t rotation = matcher.add_rule("Rotation*collision", RuleKind::GLOB);
+  uint32_t any = matcher.add_rule("*", RuleKind::GLOB);
+  matcher.compile();
+
+  // Globs match the whole text, earlier rules win over later ones
+  ASSERT_EQ(matcher.match(clearingText), clearing);
+  ASSERT_EQ(matcher.match("Clearing costmaps (3.00m)."), any);
+  ASSERT_EQ(matcher.match(collisionText), rotation);
+  ASSERT_EQ(matcher.match("Rotation cmd in collision!"), any);
+  ASSERT_EQ(matcher.match("Goal reached"), literal);
+  ASSERT_EQ(matcher.match(""), any);
+}
+
+TEST(RuleMatcherTestSuite, emptyPatternTest)
+{
+  // Create test object
+  RuleMatcher matcher;
+  uint32_t exact = matcher.add_rule("", RuleKind::EXACT);
+  uint32_t contains = matcher.add_rule("", RuleKind::CONTAINS);
+  matcher.compile();
+
+  // Empty literal is in every text but only equal to an empty one
+  ASSERT_EQ(matcher.match(""), exact);
+  ASSERT_EQ(matcher.match(planText), contains);
+}
+
+TEST(RuleMatcherTestSuite, byteClassTest)
+{
+  // Create test object with every byte value in a pattern, one more class than fits a byte
+  RuleMatcher matcher;
+  for (int byte = 0; byte < 256; byte++)
+  {
+    matcher.add_rule(std::string(1, static_cast<char>(byte)), RuleKind::EXACT);
+  }
+  uint32_t glob = matcher.add_rule(std::string("\xfe?\xff"), RuleKind::GLOB);
+  matcher.compile();
+
+  // Every byte keeps its own class, so no two bytes are confused
+  for (int byte = 0; byte < 256; byte++)
+  {
+    ASSERT_EQ(matcher.match(std::string(1, static_cast<char>(byte))), byte);
+  }
+  ASSERT_EQ(matcher.match(std::string("\xfe\x01\xff")), glob);
+  ASSERT_EQ(matcher.match(std::string("\xfe\x01\xfe")), -1);
+}
+
+TEST(RuleMatcherTestSuite, concurrentGlobTest)
+{
+  // Create test object shared by several threads, compiled before sharing
+  RuleMatcher matcher;
+  for (int idx = 0; idx < 100; idx++)
+  {
+    matcher.add_rule("Glob " + std::to_string(idx) + " *", RuleKind::GLOB);
+  }
+  uint32_t any = matcher.add_rule("*", RuleKind::GLOB);
+  matcher.compile();
+
+  // Threads build and walk the glob DFA at the same time and all see the same answers
+  std::vector<int> mismatches(4, 0);
+  std::vector<std::thread> threads;
+  for (size_t thread = 0; thread < mismatches.size(); thread++)
+  {
+    threads.push_back(std::thread([&matcher, &mismatches, any, thread]() {
+      for (int idx = 0; idx < 2000; idx++)
+      {
+        int rule = (idx * 7 + static_cast<int>(thread)) % 100;
+        if (matcher.match("Glob " + std::to_string(rule) + " at " + std::to_string(idx)) != rule)
+        {
+          mismatches[thread]++;
+        }
+        if (matcher.match("No glob " + std::to_string(idx)) != static_cast<int32_t>(any))
+        {
+          mismatches[thread]++;
+        }
+      }
+    }));
+  }
+  for (std::thread &worker : threads)
+  {
+    worker.join();
+  }
+  for (int count : mismatches)
+  {
+    ASSERT_EQ(count, 0);
+  }
+}
+
+TEST(RuleMatcherTestSuite, scalingTest)
+{
+  // Create test objects with few and many rules
+  RuleMatcher few;
+  RuleMatcher many;
+  for (int idx = 0; idx < 1000; idx++)
+  {
+    many.add_rule("rule pattern number " + std::to_string(idx) + " failed", RuleKind::CONTAINS);
+    many.add_rule("Glob " + std::to_string(idx) + " *", RuleKind::GLOB);
+  }
+  for (int idx = 0; idx < 2; idx++)
+  {
+    few.add_rule("rule pattern number " + std::to_string(idx) + " failed", RuleKind::CONTAINS);
+    few.add_rule("Glob " + std::to_string(idx) + " *", RuleKind::GLOB);
+  }
+  few.compile();
+  many.compile();
+  ASSERT_EQ(many.match("Glob 999 at the end"), 1999);
+  ASSERT_EQ(many.match("x rule pattern number 500 failed"), 1000);
+
+  // Time per message does not grow with the number of rules once states are cached
+  const int lookups = 20000;
+  auto time_per_match = [&](RuleMatcher &matcher) {
+    matcher.match(clearingText);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int idx = 0; idx < lookups; idx++)
+    {
+      matcher.match(clearingText);
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / lookups;
+  };
+  double few_us = time_per_match(few);
+  double many_us = time_per_match(many);
+  std::cout << "Rule matching: " << few_us << " us with 4 rules, " << many_us << " us with 2000 rules" << std::endl;
+  ASSERT_LT(many_us, (few_us * 5) + 1.0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <stdexcept>
+#include <error_resolution_diagnoser/single_flight.h>
+
+// Sample key
+std::string sampleText = "Aborting because a valid plan could not be found. Even after executing all recovery behaviors";
+
+TEST(SingleFlightTestSuite, coalesceTest)
+{
+  // Create test object
+  SingleFlight<int> flight;
+  pplx::task_completion_event<int> answer;
+  int starts = 0;
+  auto start = [&]() {
+    starts++;
+    return pplx::create_task(answer);
+  };
+
+  // Concurrent calls for the same key share the first call's work
+  pplx::task<int> first = flight.run(sampleText, start);
+  pplx::task<int> second = flight.run(sampleText, start);
+  ASSERT_EQ(starts, 1);
+  ASSERT_EQ(flight.in_flight_count(), 1);
+  ASSERT_EQ(flight.coalesced_count(), 1);
+
+  // Every waiter gets the result
+  answer.set(42);
+  ASSERT_EQ(first.get(), 42);
+  ASSERT_EQ(second.get(), 42);
+}
+
+TEST(SingleFlightTestSuite, distinctKeyTest)
+{
+  // Create test object
+  SingleFlight<int> flight;
+  int starts = 0;
+  auto start = [&]() {
+    starts++;
+    return pplx::task_from_result(starts);
+  };
+
+  // Different keys never share work
+  ASSERT_EQ(flight.run("first", start).get(), 1);
+  ASSERT_EQ(flight.run("second", start).get(), 2);
+  ASSERT_EQ(flight.started_count(), 2);
+  ASSERT_EQ(flight.coalesced_count(), 0);
+}
+
+TEST(SingleFlightTestSuite, completeTest)
+{
+  // Create test object
+  SingleFlight<int> flight;
+  int starts = 0;
+  auto start = [&]() {
+    starts++;
+    return pplx::task_from_result(starts);
+  };
+
+  // Once the work is done the key is forgotten and the next call starts fresh work
+  ASSERT_EQ(flight.run(sampleText, start).get(), 1);
+  while (flight.in_flight_count() > 0)
+  {
+    std::this_thread::yield();
+  }
+  ASSERT_EQ(flight.run(sampleText, start).get(), 2);
+  ASSERT_EQ(flight.coalesced_count(), 0);
+}
+
+TEST(SingleFlightTestSuite, errorTest)
+{
+  // Create test object
+  SingleFlight<int> flight;
+  pplx::task_completion_event<int> answer;
+  auto start = [&]() { return pplx::create_task(answer); };
+
+  // A failure reaches every waiter and the key is forgotten
+  pplx::task<int> first = flight.run(sampleText, start);
+  pplx::task<int> second = flight.run(sampleText, start);
+  answer.set_exception(std::runtime_error("query failed"));
+  ASSERT_THROW(first.get(), std::runtime_error);
+  ASSERT_THROW(second.get(), std::runtime_error);
+  while (flight.in_flight_count() > 0)
+  {
+    std::this_thread::yield();
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <memory>
+#include <error_resolution_diagnoser/spsc_ring.h>
+
+TEST(SpscRingTestSuite, pushPopTest)
+{
+  // Create test object, capacity is rounded up to a power of two
+  SpscRing<int> ring(3);
+  ASSERT_EQ(ring.capacity(), 4);
+
+  // Empty ring has nothing to pop
+  int item = 0;
+  ASSERT_FALSE(ring.pop(item));
+
+  // Items come out in order
+  ASSERT_TRUE(ring.push(1));
+  ASSERT_TRUE(ring.push(2));
+  ASSERT_EQ(ring.depth(), 2);
+  ASSERT_TRUE(ring.pop(item));
+  ASSERT_EQ(item, 1);
+  ASSERT_TRUE(ring.pop(item));
+  ASSERT_EQ(item, 2);
+  ASSERT_EQ(ring.depth(), 0);
+}
+
+TEST(SpscRingTestSuite, overflowTest)
+{
+  // Create test object
+  SpscRing<int> ring(4);
+
+  // Fill the ring, further pushes are dropped and counted
+  for (int idx = 0; idx < 4; idx++)
+  {
+    ASSERT_TRUE(ring.push(idx));
+  }
+  ASSERT_FALSE(ring.push(4));
+  ASSERT_FALSE(ring.push(5));
+  ASSERT_EQ(ring.overflow_count(), 2);
+  ASSERT_EQ(ring.depth(), 4);
+
+  // Popping makes room again
+  int item = 0;
+  ASSERT_TRUE(ring.pop(item));
+  ASSERT_EQ(item, 0);
+  ASSERT_TRUE(ring.push(6));
+}
+
+TEST(SpscRingTestSuite, releaseTest)
+{
+  // Popped slots must not keep shared pointers alive
+  SpscRing<std::shared_ptr<int>> ring(2);
+  std::shared_ptr<int> sample(new int(42));
+
+  ring.push(sample);
+  ASSERT_EQ(sample.use_count(), 2);
+
+  std::shared_ptr<int> item;
+  ASSERT_TRUE(ring.pop(item));
+  item.reset();
+  ASSERT_EQ(sample.use_count(), 1);
+}
+
+TEST(SpscRingTestSuite, threadedTest)
+{
+  // One producer and one consumer pass a sequence through a small ring
+  SpscRing<int> ring(64);
+  const int count = 100000;
+  long long sum = 0;
+  bool ordered = true;
+
+  std::thread consumer([&]() {
+    int expected = 0;
+    int item = 0;
+    while (expected < count)
+    {
+      if (ring.pop(item))
+      {
+        ordered = ordered && (item == expected);
+        sum += item;
+        expected++;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for (int idx = 0; idx < count; idx++)
+  {
+    // Retry while full, nothing may be lost in this test
+    while (!ring.push(idx))
+    {
+      std::this_thread::yield();
+    }
+  }
+  consumer.join();
+
+  ASSERT_TRUE(ordered);
+  ASSERT_EQ(sum, (long long)count * (count - 1) / 2);
+  ASSERT_EQ(ring.depth(), 0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
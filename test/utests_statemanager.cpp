@@ -2,6 +2,8 @@
 #include <gtest/gtest.h>
 #include <fstream>
 #include <cstdlib>
+#include <chrono>
+#include <thread>
 #include <error_resolution_diagnoser/state_manager.h>
 
 using namespace web::json; // JSON features
@@ -304,6 +306,128 @@ TEST(StateManagerTestSuite, clearTest)
   ASSERT_EQ(found[0], "");
 }
 
+TEST(StateManagerTestSuite, warningTimeoutTest)
+{
+  // Sample message
+  std::string sampleRobotCode = "SampleRobotCode";
+  std::string sampleMsgText = "This is a sample warning text";
+
+  // Set warning timeout to 0.005 min (0.3 s) and keep info suppressed for good
+  char warning_timeout[50] = "ALERT_TIMEOUT_WARNING=0.005";
+  char info_timeout[50] = "ALERT_TIMEOUT_INFO=0";
+  putenv(warning_timeout);
+  putenv(info_timeout);
+
+  // Create new state manager instance
+  StateManager sm_timeout;
+  unsetenv("ALERT_TIMEOUT_WARNING");
+  unsetenv("ALERT_TIMEOUT_INFO");
+
+  // First warning and info are recorded, repeats are suppressed
+  sm_timeout.check_warning(sampleRobotCode, sampleMsgText);
+  sm_timeout.check_info(sampleRobotCode, infoMessage);
+  found = sm_timeout.does_exist(sampleRobotCode, sampleMsgText);
+  ASSERT_EQ(found[1], sampleMsgText);
+
+  // Wait past the warning timeout
+  std::this_thread::sleep_for(std::chrono::milliseconds(600));
+
+  // Warning has expired and resurfaces as a new record, info never expires
+  sm_timeout.check_info(sampleRobotCode, infoMessage);
+  found = sm_timeout.does_exist(sampleRobotCode, infoMessage);
+  ASSERT_EQ(found[1], infoMessage);
+  found = sm_timeout.does_exist(sampleRobotCode, sampleMsgText);
+  ASSERT_TRUE(found[0].empty());
+  sm_timeout.check_warning(sampleRobotCode, sampleMsgText);
+  found = sm_timeout.does_exist(sampleRobotCode, sampleMsgText);
+  ASSERT_EQ(found[1], sampleMsgText);
+
+  // Clear state manager
+  sm_timeout.clear();
+}
+
+TEST(StateManagerTestSuite, stateLimitTest)
+{
+  // Sample message
+  std::string sampleRobotCode = "SampleRobotCode";
+
+  // Create new state manager instance limited to 100 messages
+  StateManager sm_limit;
+  sm_limit.set_state_limits(100, 0);
+
+  // Record 1000 distinct messages
+  for (int idx = 0; idx < 1000; idx++)
+  {
+    sm_limit.check_info(sampleRobotCode, "Chatty message " + std::to_string(idx));
+  }
+
+  // Only the most recent 100 are kept, the rest are counted as evictions
+  StateUsage usage = sm_limit.get_msg_usage();
+  ASSERT_EQ(usage.entries, 100);
+  ASSERT_EQ(usage.evictions, 900);
+  ASSERT_GT(usage.bytes, 0);
+  found = sm_limit.does_exist(sampleRobotCode, "Chatty message 999");
+  ASSERT_EQ(found[1], "Chatty message 999");
+  found = sm_limit.does_exist(sampleRobotCode, "Chatty message 0");
+  ASSERT_TRUE(found[0].empty());
+
+  // Clear state manager
+  sm_limit.clear();
+  ASSERT_EQ(sm_limit.get_msg_usage().bytes, 0);
+}
+
+// Utility function to time suppressed lookups of already recorded messages
+double timeSuppressedLookups(StateManager &sm, const std::string &robot_code, int num_entries, int num_lookups)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int idx = 0; idx < num_lookups; idx++)
+  {
+    sm.check_info(robot_code, "Distinct message " + std::to_string((idx * 7919) % num_entries));
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::nano>(stop - start).count() / num_lookups;
+}
+
+TEST(StateManagerTestSuite, existScalingTest)
+{
+  // Sample message
+  std::string sampleRobotCode = "SampleRobotCode";
+  int smallSize = 1000;
+  int largeSize = 100000;
+  int numLookups = 20000;
+
+  // Lift the default ceiling so all 100k entries stay recorded
+  state_manager_instance.set_state_limits(0, 0);
+
+  // Record a small number of distinct messages and time lookups against them
+  for (int idx = 0; idx < smallSize; idx++)
+  {
+    state_manager_instance.check_info(sampleRobotCode, "Distinct message " + std::to_string(idx));
+  }
+  double smallCost = timeSuppressedLookups(state_manager_instance, sampleRobotCode, smallSize, numLookups);
+
+  // Grow the table to 100k distinct messages and time the same number of lookups
+  for (int idx = smallSize; idx < largeSize; idx++)
+  {
+    state_manager_instance.check_info(sampleRobotCode, "Distinct message " + std::to_string(idx));
+  }
+  double largeCost = timeSuppressedLookups(state_manager_instance, sampleRobotCode, largeSize, numLookups);
+  std::cout << "Per-message cost at " << smallSize << " entries: " << smallCost << " ns, at "
+            << largeSize << " entries: " << largeCost << " ns" << std::endl;
+
+  // Every lookup hit a recorded message so all of them must be suppressed
+  found = state_manager_instance.does_exist(sampleRobotCode, "Distinct message " + std::to_string(largeSize - 1));
+  ASSERT_EQ(found[1], "Distinct message " + std::to_string(largeSize - 1));
+
+  // A linear scan would be ~100x slower at 100k entries, a hash index stays flat apart from cache effects
+  ASSERT_LT(largeCost, smallCost * 10);
+
+  // Clear state manager and restore a ceiling
+  state_manager_instance.clear();
+  state_manager_instance.set_state_limits(10000, 4 * 1024 * 1024);
+}
+
 TEST(StateManagerTestSuite, checkMessageERTErrorTest)
 {
   // Clean up logs
@@ -596,6 +720,125 @@ TEST(StateManagerTestSuite, checkMessageECSInfoTest)
   sm_ecs.clear();
 }
 
+TEST(StateManagerTestSuite, checkMessageClassifiedTest)
+{
+  // Clean up logs
+  logCleanup();
+
+  // Sample error message
+  std::string sampleRobotCode = "SampleRobotCode";
+  rosgraph_msgs::Log data;
+  data.level = 8;
+  data.name = "/move_base";
+  data.msg = errorMessage;
+  rosgraph_msgs::Log::ConstPtr rosmsg(new rosgraph_msgs::Log(data));
+
+  // Set mode to ECS
+  char agent_type[50] = "AGENT_TYPE=ECS";
+  char ecs_api[200] = "ECS_API=http://0.0.0.0:8000";
+  char ecs_robot_model[200] = "ECS_ROBOT_MODEL=Turtlebot3";
+  putenv(agent_type);
+  putenv(ecs_api);
+  putenv(ecs_robot_model);
+
+  // Create new state manager instance
+  StateManager sm_ecs;
+
+  // Classification already looked up, no query is sent
+  json::value msg_info;
+  msg_info["severity"] = json::value::number(8);
+  msg_info["error_text"] = json::value::string(errorMessage);
+  msg_info["error_module"] = json::value::string("Navigation");
+  msg_info["error_source"] = json::value::string("/move_base");
+  msg_info["compounding_flag"] = json::value::boolean(true);
+
+  // Call check_message with the classification
+  sm_ecs.check_message("ECS", sampleRobotCode, rosmsg, telemetry, msg_info);
+
+  // Check if log is created
+  log_id++;
+  std::string filename = log_name + std::to_string(log_id) + log_ext;
+  std::ifstream infile1(filename);
+  bool fileflag = infile1.good();
+  ASSERT_TRUE(fileflag);
+
+  // A message that is not in the table does not create an event
+  sm_ecs.check_message("ECS", sampleRobotCode, rosmsg, telemetry, json::value::null());
+  std::ifstream infile2(log_name + std::to_string(log_id + 1) + log_ext);
+  fileflag = infile2.good();
+  ASSERT_FALSE(fileflag);
+
+  // Clear state manager
+  sm_ecs.clear();
+}
+
+TEST(StateManagerTestSuite, checkMessageRulesTest)
+{
+  // Clean up logs
+  logCleanup();
+
+  // Sample error message
+  std::string sampleRobotCode = "SampleRobotCode";
+  rosgraph_msgs::Log data;
+  data.level = 8;
+  data.name = "/move_base";
+  data.msg = errorMessage;
+  rosgraph_msgs::Log::ConstPtr rosmsg(new rosgraph_msgs::Log(data));
+
+  // Sample rules file
+  std::string rules_path = testing::TempDir() + "rules_unittest.json";
+  std::ofstream rules_out(rules_path, std::ios::trunc);
+  rules_out << "[{\"pattern\": \"Aborting because\", \"match\": \"prefix\", \"severity\": 8, \"compounding_flag\": true, "
+               "\"error_module\": \"Navigation\", \"error_source\": \"/move_base\"},"
+               "{\"pattern\": \"*failed to produce*\", \"match\": \"glob\", \"severity\": 4},"
+               "{\"pattern\": \"Got new plan\", \"match\": \"unknown\", \"severity\": 2}]";
+  rules_out.close();
+
+  // Set mode to RULES
+  static char agent_type[50] = "AGENT_TYPE=RULES";
+  static char rules_file[200];
+  snprintf(rules_file, sizeof(rules_file), "RULES_FILE=%s", rules_path.c_str());
+  putenv(agent_type);
+  putenv(rules_file);
+
+  // Create new state manager instance, rules with an unknown match type are skipped
+  StateManager sm_rules;
+  unsetenv("RULES_FILE");
+  std::remove(rules_path.c_str());
+  ASSERT_EQ(sm_rules.get_rule_count(), 2);
+
+  // Rule hit follows the ECS message cycle
+  sm_rules.check_message("RULES", sampleRobotCode, rosmsg, telemetry);
+  log_id++;
+  std::string filename = log_name + std::to_string(log_id) + log_ext;
+  std::ifstream infile1(filename);
+  bool fileflag = infile1.good();
+  ASSERT_TRUE(fileflag);
+
+  // Lookups resolve in place
+  ASSERT_TRUE(sm_rules.classify_message(warningMessage).is_done());
+  ASSERT_EQ(sm_rules.classify_message(warningMessage).get().at("severity").as_integer(), 4);
+  ASSERT_TRUE(sm_rules.classify_message(infoMessage).get().is_null());
+
+  // A message no rule matches does not create an event
+  data.msg = infoMessage;
+  rosgraph_msgs::Log::ConstPtr infomsg(new rosgraph_msgs::Log(data));
+  sm_rules.check_message("RULES", sampleRobotCode, infomsg, telemetry);
+  std::ifstream infile2(log_name + std::to_string(log_id + 1) + log_ext);
+  fileflag = infile2.good();
+  ASSERT_FALSE(fileflag);
+
+  // A missing rules file loads no rules, so the listener falls back to ROS mode
+  putenv(rules_file);
+  StateManager sm_norules;
+  unsetenv("RULES_FILE");
+  unsetenv("AGENT_TYPE");
+  ASSERT_EQ(sm_norules.get_rule_count(), 0);
+
+  // Clear state manager
+  sm_rules.clear();
+}
+
 TEST(StateManagerTestSuite, diagExistTest)
 {
   // Sample message
@@ -652,6 +895,38 @@ TEST(StateManagerTestSuite, checkDiagTest)
   state_manager_instance.clear();
 }
 
+TEST(StateManagerTestSuite, checkDiagTransitionTest)
+{
+  // Sample message
+  std::string sampleRobotCode = "SampleRobotCode";
+  std::string sampleDiagStr = "/test2";
+  std::string errorLvl = "2";
+  std::string okLvl = "0";
+
+  // Record diagnostic at error level
+  state_manager_instance.check_diag_data(sampleRobotCode, sampleDiagStr, errorLvl);
+
+  // Transition diagnostic to OK level
+  state_manager_instance.check_diag_data(sampleRobotCode, sampleDiagStr, okLvl);
+
+  // Old level should no longer be reported as existing
+  found = state_manager_instance.does_diag_exist(sampleRobotCode, sampleDiagStr, errorLvl);
+  ASSERT_TRUE(found[0].empty());
+
+  // New level should be recorded in place of the old one
+  found = state_manager_instance.does_diag_exist(sampleRobotCode, sampleDiagStr, okLvl);
+  ASSERT_EQ(found[1], sampleDiagStr);
+  ASSERT_EQ(found[2], okLvl);
+
+  // Going back to error level is a transition again
+  state_manager_instance.check_diag_data(sampleRobotCode, sampleDiagStr, errorLvl);
+  found = state_manager_instance.does_diag_exist(sampleRobotCode, sampleDiagStr, errorLvl);
+  ASSERT_EQ(found[2], errorLvl);
+
+  // Clear state manager
+  state_manager_instance.clear();
+}
+
 TEST(StateManagerTestSuite, checkDiagROSTest)
 {
   // Clean up logs
@@ -806,9 +1081,247 @@ TEST(StateManagerTestSuite, checkDiagECSTest)
   sm_diag_ecs.clear();
 }
 
+TEST(StateManagerTestSuite, templateDedupTest)
+{
+  // Clean up logs
+  logCleanup();
+
+  // Sample numeric variants of the same warning
+  std::string sampleRobotCode = "SampleRobotCode";
+  rosgraph_msgs::Log data;
+  data.level = 4;
+  data.name = "/move_base";
+  data.msg = "Invalid Trajectory 0.000000, 0.000000, -0.400000, cost: -6.000000";
+  rosgraph_msgs::Log::ConstPtr rosmsg1(new rosgraph_msgs::Log(data));
+  data.msg = "Invalid Trajectory 0.100000, 0.000000, 0.400000, cost: -4.500000";
+  rosgraph_msgs::Log::ConstPtr rosmsg2(new rosgraph_msgs::Log(data));
+
+  // Set dedup mode to template
+  char dedup_mode[50] = "LOG_DEDUP_MODE=TEMPLATE";
+  putenv(dedup_mode);
+
+  // Create new state manager instance
+  StateManager sm_template;
+  unsetenv("LOG_DEDUP_MODE");
+
+  // First variant is logged
+  sm_template.check_message_ros(sampleRobotCode, rosmsg1, telemetry);
+  log_id++;
+  std::string filename = log_name + std::to_string(log_id) + log_ext;
+  std::ifstream infile1(filename);
+  ASSERT_TRUE(infile1.good());
+
+  // Second variant shares the template and is suppressed, so no new log is created
+  sm_template.check_message_ros(sampleRobotCode, rosmsg2, telemetry);
+  filename = log_name + std::to_string(log_id + 1) + log_ext;
+  std::ifstream infile2(filename);
+  ASSERT_FALSE(infile2.good());
+  ASSERT_EQ(sm_template.get_template_count(), 1);
+
+  // Clear state manager
+  sm_template.clear();
+}
+
+TEST(StateManagerTestSuite, templateDedupClassifiedTest)
+{
+  // Clean up logs
+  logCleanup();
+
+  // Sample numeric variants of the same warning
+  std::string sampleRobotCode = "SampleRobotCode";
+  rosgraph_msgs::Log data;
+  data.level = 4;
+  data.name = "/move_base";
+  data.msg = "Clearing both costmaps to unstuck robot (1.84m).";
+  rosgraph_msgs::Log::ConstPtr rosmsg1(new rosgraph_msgs::Log(data));
+  data.msg = "Clearing both costmaps to unstuck robot (3.00m).";
+  rosgraph_msgs::Log::ConstPtr rosmsg2(new rosgraph_msgs::Log(data));
+
+  // Variants classified with their own table rows
+  json::value msg_info1;
+  msg_info1["severity"] = json::value::number(4);
+  msg_info1["error_text"] = json::value::string(rosmsg1->msg);
+  msg_info1["error_module"] = json::value::string("Navigation");
+  msg_info1["error_source"] = json::value::string("/move_base");
+  msg_info1["compounding_flag"] = json::value::boolean(true);
+  json::value msg_info2 = msg_info1;
+  msg_info2["error_text"] = json::value::string(rosmsg2->msg);
+
+  // Set dedup mode to template
+  char dedup_mode[50] = "LOG_DEDUP_MODE=TEMPLATE";
+  putenv(dedup_mode);
+
+  // Create new state manager instance
+  StateManager sm_template;
+  unsetenv("LOG_DEDUP_MODE");
+
+  // First variant is logged
+  sm_template.check_message("ECS", sampleRobotCode, rosmsg1, telemetry, msg_info1);
+  log_id++;
+  std::string filename = log_name + std::to_string(log_id) + log_ext;
+  std::ifstream infile1(filename);
+  ASSERT_TRUE(infile1.good());
+
+  // Second variant is suppressed on the template, not on the row it was classified as
+  sm_template.check_message("ECS", sampleRobotCode, rosmsg2, telemetry, msg_info2);
+  filename = log_name + std::to_string(log_id + 1) + log_ext;
+  std::ifstream infile2(filename);
+  ASSERT_FALSE(infile2.good());
+
+  // Template is bounded like the suppression tables
+  StateUsage usage = sm_template.get_template_usage();
+  ASSERT_EQ(usage.entries, 1);
+  ASSERT_GT(usage.bytes, 0);
+
+  // Clear state manager
+  sm_template.clear();
+}
+
+TEST(StateManagerTestSuite, templateDedupConstantTest)
+{
+  // Clean up logs
+  logCleanup();
+
+  // Sample messages that only differ in a word
+  std::string sampleRobotCode = "SampleRobotCode";
+  rosgraph_msgs::Log data;
+  data.level = 4;
+  data.name = "/move_base";
+  data.msg = "Goal reached";
+  rosgraph_msgs::Log::ConstPtr rosmsg1(new rosgraph_msgs::Log(data));
+  data.msg = "Goal aborted";
+  rosgraph_msgs::Log::ConstPtr rosmsg2(new rosgraph_msgs::Log(data));
+
+  // Sample table classifying them differently
+  std::string table_path = testing::TempDir() + "ecs_table_template_unittest.json";
+  std::ofstream table_out(table_path, std::ios::trunc);
+  table_out << "[{\"error_text\": \"Goal reached\", \"severity\": 4, \"compounding_flag\": false, \"error_module\": \"Navigation\", "
+               "\"error_source\": \"/move_base\"},"
+               "{\"error_text\": \"Goal aborted\", \"severity\": 8, \"compounding_flag\": false, \"error_module\": \"Navigation\", "
+               "\"error_source\": \"/move_base\"}]";
+  table_out.close();
+
+  // Set mode to ECS from the table, with template dedup
+  static char agent_type[50] = "AGENT_TYPE=ECS";
+  static char ecs_robot_model[200] = "ECS_ROBOT_MODEL=Turtlebot3";
+  static char ecs_table_file[200];
+  snprintf(ecs_table_file, sizeof(ecs_table_file), "ECS_TABLE_FILE=%s", table_path.c_str());
+  static char dedup_mode[50] = "LOG_DEDUP_MODE=TEMPLATE";
+  putenv(agent_type);
+  putenv(ecs_robot_model);
+  putenv(ecs_table_file);
+  putenv(dedup_mode);
+
+  // Create new state manager instance
+  StateManager sm_template;
+  unsetenv("LOG_DEDUP_MODE");
+  unsetenv("ECS_TABLE_FILE");
+  unsetenv("ECS_ROBOT_MODEL");
+  unsetenv("AGENT_TYPE");
+  std::remove(table_path.c_str());
+
+  // Each message keeps its own classification
+  ASSERT_EQ(sm_template.classify_message(rosmsg1->msg).get().at("severity").as_integer(), 4);
+  ASSERT_EQ(sm_template.classify_message(rosmsg2->msg).get().at("severity").as_integer(), 8);
+
+  // Both are logged, the second is not suppressed under the first one's template
+  sm_template.check_message("ECS", sampleRobotCode, rosmsg1, telemetry);
+  log_id++;
+  std::string filename = log_name + std::to_string(log_id) + log_ext;
+  std::ifstream infile1(filename);
+  ASSERT_TRUE(infile1.good());
+  sm_template.check_message("ECS", sampleRobotCode, rosmsg2, telemetry);
+  log_id++;
+  filename = log_name + std::to_string(log_id) + log_ext;
+  std::ifstream infile2(filename);
+  ASSERT_TRUE(infile2.good());
+  ASSERT_EQ(sm_template.get_template_count(), 2);
+
+  // Clear state manager
+  sm_template.clear();
+}
+
+TEST(StateManagerTestSuite, emptyTableTest)
+{
+  // Set mode to ECS from a table that does not exist, without an API to fall back on
+  static char agent_type[50] = "AGENT_TYPE=ECS";
+  static char ecs_robot_model[200] = "ECS_ROBOT_MODEL=Turtlebot3";
+  static char ecs_table_file[200];
+  snprintf(ecs_table_file, sizeof(ecs_table_file), "ECS_TABLE_FILE=%s", (testing::TempDir() + "ecs_table_missing_unittest.json").c_str());
+  putenv(agent_type);
+  putenv(ecs_robot_model);
+  putenv(ecs_table_file);
+
+  // Create new state manager instance, nothing can be classified so it defaults back to ROS mode
+  StateManager sm_empty;
+  unsetenv("ECS_TABLE_FILE");
+  unsetenv("ECS_ROBOT_MODEL");
+  unsetenv("AGENT_TYPE");
+  ASSERT_EQ(sm_empty.get_agent_type(), "ROS");
+}
+
+TEST(StateManagerTestSuite, callSiteDedupTest)
+{
+  // Clean up logs
+  logCleanup();
+
+  // Sample warnings formatted by the same logging statement
+  std::string sampleRobotCode = "SampleRobotCode";
+  rosgraph_msgs::Log data;
+  data.level = 4;
+  data.name = "/move_base";
+  data.file = "/tmp/navigation/move_base/src/move_base.cpp";
+  data.function = "MoveBase::executeCycle";
+  data.line = 1043;
+  data.msg = "Clearing both costmaps to unstuck robot (1.84m).";
+  rosgraph_msgs::Log::ConstPtr rosmsg1(new rosgraph_msgs::Log(data));
+  data.msg = "Clearing both costmaps to unstuck robot (3.00m).";
+  rosgraph_msgs::Log::ConstPtr rosmsg2(new rosgraph_msgs::Log(data));
+
+  // Same text from another line is a different call site
+  data.line = 1050;
+  rosgraph_msgs::Log::ConstPtr rosmsg3(new rosgraph_msgs::Log(data));
+
+  // Set dedup mode to call site
+  char dedup_mode[50] = "LOG_DEDUP_MODE=CALLSITE";
+  putenv(dedup_mode);
+
+  // Create new state manager instance
+  StateManager sm_callsite;
+  unsetenv("LOG_DEDUP_MODE");
+
+  // First message is logged
+  sm_callsite.check_message_ros(sampleRobotCode, rosmsg1, telemetry);
+  log_id++;
+  std::string filename = log_name + std::to_string(log_id) + log_ext;
+  std::ifstream infile1(filename);
+  ASSERT_TRUE(infile1.good());
+
+  // Second message comes from the same call site and is suppressed
+  sm_callsite.check_message_ros(sampleRobotCode, rosmsg2, telemetry);
+  filename = log_name + std::to_string(log_id + 1) + log_ext;
+  std::ifstream infile2(filename);
+  ASSERT_FALSE(infile2.good());
+
+  // Third message comes from another call site and is logged
+  sm_callsite.check_message_ros(sampleRobotCode, rosmsg3, telemetry);
+  log_id++;
+  filename = log_name + std::to_string(log_id) + log_ext;
+  std::ifstream infile3(filename);
+  ASSERT_TRUE(infile3.good());
+
+  // Clear state manager
+  sm_callsite.clear();
+}
+
 int main(int argc, char **argv)
 {
   // Start tests
   testing::InitGoogleTest(&argc, argv);
+
+  // ECS mode tests save their classification cache away from the agent's own
+  static char ecs_cache_file[200];
+  snprintf(ecs_cache_file, sizeof(ecs_cache_file), "ECS_CACHE_FILE=%s", (testing::TempDir() + "ecs_cache_statemanager_unittest.bin").c_str());
+  putenv(ecs_cache_file);
   return RUN_ALL_TESTS();
 }
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <ctime>
+#include <error_resolution_diagnoser/state_table.h>
+
+// Sample state
+struct SampleState
+{
+  int level;
+};
+
+// Sample keys
+std::string sampleRobotCode = "SampleRobotCode";
+std::string sampleMsgText = "This is sample text";
+
+TEST(StateTableTestSuite, insertFindTest)
+{
+  // Create test object
+  StateTable<SampleState> table;
+  SampleState state;
+  state.level = 4;
+
+  // Nothing recorded yet
+  ASSERT_EQ(table.find(sampleRobotCode, sampleMsgText), nullptr);
+
+  // Insert and find again
+  table.insert(sampleRobotCode, sampleMsgText, state);
+  ASSERT_NE(table.find(sampleRobotCode, sampleMsgText), nullptr);
+  ASSERT_EQ(table.find(sampleRobotCode, sampleMsgText)->level, 4);
+
+  // Same text for a different robot is a different key
+  ASSERT_EQ(table.find("OtherRobotCode", sampleMsgText), nullptr);
+
+  // Overwrite in place keeps a single entry
+  state.level = 8;
+  table.insert(sampleRobotCode, sampleMsgText, state);
+  ASSERT_EQ(table.size(), 1);
+  ASSERT_EQ(table.find(sampleRobotCode, sampleMsgText)->level, 8);
+
+  // Erase
+  ASSERT_TRUE(table.erase(sampleRobotCode, sampleMsgText));
+  ASSERT_FALSE(table.erase(sampleRobotCode, sampleMsgText));
+  ASSERT_EQ(table.size(), 0);
+}
+
+TEST(StateTableTestSuite, expireTest)
+{
+  // Create test object, starting the clock at tick 1000
+  StateTable<SampleState> table;
+  SampleState state;
+  state.level = 4;
+  table.expire(1000);
+
+  // One entry expiring after 300 ticks, one after 5 ticks and one that never expires
+  table.insert(sampleRobotCode, "Expires late", state, 1300);
+  table.insert(sampleRobotCode, "Expires early", state, 1005);
+  table.insert(sampleRobotCode, "Never expires", state);
+
+  // Nothing is due yet
+  ASSERT_EQ(table.expire(1004), 0);
+  ASSERT_EQ(table.size(), 3);
+
+  // Early entry expires on its tick
+  ASSERT_EQ(table.expire(1005), 1);
+  ASSERT_EQ(table.find(sampleRobotCode, "Expires early"), nullptr);
+
+  // Jumping far ahead expires the late entry but keeps the permanent one
+  ASSERT_EQ(table.expire(100000), 1);
+  ASSERT_EQ(table.find(sampleRobotCode, "Expires late"), nullptr);
+  ASSERT_NE(table.find(sampleRobotCode, "Never expires"), nullptr);
+
+  // Erased entries are taken off the wheel as well
+  table.insert(sampleRobotCode, "Erased", state, 100010);
+  table.erase(sampleRobotCode, "Erased");
+  ASSERT_EQ(table.expire(100020), 0);
+}
+
+TEST(StateTableTestSuite, timingWheelCascadeTest)
+{
+  // Entries spread over every level of the wheel, including beyond its range
+  StateTable<SampleState> table;
+  SampleState state;
+  state.level = 2;
+  table.expire(1);
+
+  std::vector<uint64_t> delays = {1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 16777215, 16777216, 33554433};
+  for (uint64_t delay : delays)
+  {
+    table.insert(sampleRobotCode, std::to_string(delay), state, 1 + delay);
+  }
+
+  // Each entry must expire exactly on its tick, never before
+  for (uint64_t delay : delays)
+  {
+    ASSERT_NE(table.find(sampleRobotCode, std::to_string(delay)), nullptr);
+    table.expire(delay);
+    ASSERT_NE(table.find(sampleRobotCode, std::to_string(delay)), nullptr);
+    table.expire(1 + delay);
+    ASSERT_EQ(table.find(sampleRobotCode, std::to_string(delay)), nullptr);
+  }
+  ASSERT_EQ(table.size(), 0);
+}
+
+TEST(StateTableTestSuite, lruEntryLimitTest)
+{
+  // Table limited to 3 entries
+  StateTable<SampleState> table;
+  SampleState state;
+  state.level = 4;
+  table.set_limits(3, 0);
+
+  table.insert(sampleRobotCode, "First", state);
+  table.insert(sampleRobotCode, "Second", state);
+  table.insert(sampleRobotCode, "Third", state);
+
+  // Using the first entry makes the second one least recently used
+  ASSERT_NE(table.find(sampleRobotCode, "First"), nullptr);
+  table.insert(sampleRobotCode, "Fourth", state);
+
+  ASSERT_EQ(table.size(), 3);
+  ASSERT_EQ(table.find(sampleRobotCode, "Second"), nullptr);
+  ASSERT_NE(table.find(sampleRobotCode, "First"), nullptr);
+  ASSERT_EQ(table.usage().evictions, 1);
+}
+
+TEST(StateTableTestSuite, lruByteLimitTest)
+{
+  // Measure footprint of a single entry with a long text
+  StateTable<SampleState> table;
+  SampleState state;
+  state.level = 2;
+  std::string longText(200, 'x');
+  table.insert(sampleRobotCode, longText + "0", state);
+  size_t entryBytes = table.usage().bytes;
+  ASSERT_GT(entryBytes, longText.size());
+
+  // Limit the table to about 10 such entries and insert 100
+  table.set_limits(0, entryBytes * 10);
+  for (int idx = 1; idx < 100; idx++)
+  {
+    table.insert(sampleRobotCode, longText + std::to_string(idx), state);
+  }
+
+  // Footprint stays within the ceiling and the newest entries are kept
+  StateUsage current = table.usage();
+  ASSERT_LE(current.bytes, entryBytes * 10);
+  ASSERT_EQ(current.entries + current.evictions, 100);
+  ASSERT_NE(table.find(sampleRobotCode, longText + "99"), nullptr);
+  ASSERT_EQ(table.find(sampleRobotCode, longText + "0"), nullptr);
+
+  // Footprint goes back to zero once cleared
+  table.clear();
+  ASSERT_EQ(table.usage().bytes, 0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <error_resolution_diagnoser/telemetry.h>
+
+using namespace web::json; // JSON features
+using namespace web;       // Common features like URIs.
+
+// Sample pose
+PoseState samplePose(double value)
+{
+  PoseState pose;
+  pose.valid = true;
+  pose.position_x = value;
+  pose.position_y = value;
+  pose.position_z = value;
+  pose.orientation_w = value;
+  pose.orientation_x = value;
+  pose.orientation_y = value;
+  pose.orientation_z = value;
+  return pose;
+}
+
+TEST(TelemetryTestSuite, seqlockTest)
+{
+  // Create test object, starts value initialized
+  Seqlock<PoseState> lock;
+  ASSERT_FALSE(lock.load().valid);
+  ASSERT_EQ(lock.version(), 0);
+
+  // Stored value is read back and counted
+  lock.store(samplePose(1.5));
+  ASSERT_TRUE(lock.load().valid);
+  ASSERT_EQ(lock.load().orientation_z, 1.5);
+  ASSERT_EQ(lock.version(), 1);
+}
+
+TEST(TelemetryTestSuite, seqlockThreadedTest)
+{
+  // One writer keeps every field equal, readers must never see a torn pose
+  Seqlock<PoseState> lock;
+  std::atomic<bool> running(true);
+  bool consistent = true;
+
+  std::thread writer([&]() {
+    double value = 0.0;
+    while (running)
+    {
+      lock.store(samplePose(value));
+      value += 1.0;
+    }
+  });
+
+  for (int idx = 0; idx < 100000; idx++)
+  {
+    PoseState pose = lock.load();
+    consistent = consistent && (pose.position_x == pose.position_y) && (pose.position_x == pose.position_z) &&
+                 (pose.position_x == pose.orientation_w) && (pose.position_x == pose.orientation_x) &&
+                 (pose.position_x == pose.orientation_y) && (pose.position_x == pose.orientation_z);
+  }
+  running = false;
+  writer.join();
+
+  ASSERT_TRUE(consistent);
+}
+
+TEST(TelemetryTestSuite, toJsonTest)
+{
+  // Create test object
+  TelemetryStore store;
+
+  // No pose received yet, telemetry is an empty object
+  json::value telemetry = Telemetry(store.snapshot()).to_json();
+  ASSERT_TRUE(telemetry.is_object());
+  ASSERT_FALSE(telemetry.has_field(utility::conversions::to_string_t("odom_pose")));
+  ASSERT_FALSE(telemetry.has_field(utility::conversions::to_string_t("nav_pose")));
+
+  // Only received poses are reported
+  store.set_odom_pose(samplePose(2.0));
+  telemetry = Telemetry(store.snapshot()).to_json();
+  ASSERT_TRUE(telemetry.has_field(utility::conversions::to_string_t("odom_pose")));
+  ASSERT_FALSE(telemetry.has_field(utility::conversions::to_string_t("nav_pose")));
+
+  // Pose keeps the orientation and position layout
+  json::value odom_pose = telemetry.at(utility::conversions::to_string_t("odom_pose"));
+  json::value position = odom_pose.at(utility::conversions::to_string_t("position"));
+  json::value orientation = odom_pose.at(utility::conversions::to_string_t("orientation"));
+  ASSERT_EQ(position.at(utility::conversions::to_string_t("x")).as_double(), 2.0);
+  ASSERT_EQ(orientation.at(utility::conversions::to_string_t("w")).as_double(), 2.0);
+
+  // Ready JSON values are passed through
+  json::value sample = json::value::parse("{ \"pose\" : 42 }");
+  ASSERT_EQ(Telemetry(sample).to_json().serialize(), sample.serialize());
+}
+
+TEST(TelemetryTestSuite, serializeCacheTest)
+{
+  // Create test object
+  TelemetryStore store;
+  store.set_odom_pose(samplePose(1.0));
+  TelemetrySnapshot first = store.snapshot();
+
+  // Republishing the same pose is not a change
+  store.set_odom_pose(samplePose(1.0));
+  TelemetrySnapshot second = store.snapshot();
+  ASSERT_EQ(first.odom_version, second.odom_version);
+  ASSERT_EQ(first.nav_version, second.nav_version);
+
+  // Serialization is shared by snapshots of the same version and matches the JSON
+  std::shared_ptr<const std::string> first_str = Telemetry(first, &store).serialized();
+  ASSERT_EQ(Telemetry(second, &store).serialized(), first_str);
+  ASSERT_EQ(*first_str, snapshot_to_json(first).serialize());
+
+  // A new pose is a new version with a new serialization
+  store.set_nav_pose(samplePose(3.0));
+  TelemetrySnapshot third = store.snapshot();
+  ASSERT_GT(third.nav_version, second.nav_version);
+  ASSERT_NE(*Telemetry(third, &store).serialized(), *first_str);
+
+  // An older snapshot still serializes to its own poses
+  ASSERT_EQ(*Telemetry(first, &store).serialized(), *first_str);
+
+  // Another state whose versions add up to the same total is not served from the cache
+  TelemetrySnapshot other = third;
+  other.odom_pose = PoseState();
+  other.odom_version = third.odom_version - 1;
+  other.nav_version = third.nav_version + 1;
+  ASSERT_EQ(*Telemetry(other, &store).serialized(), snapshot_to_json(other).serialize());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
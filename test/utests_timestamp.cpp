@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <ctime>
+#include <cstdlib>
+#include <boost/date_time.hpp>
+#include <error_resolution_diagnoser/timestamp.h>
+
+// Stand-in for a ROS header stamp
+struct SampleStamp
+{
+  uint32_t sec;
+  uint32_t nsec;
+};
+
+// Reference text from boost for the same time
+std::string boostIso(int64_t sec, uint32_t usec)
+{
+  boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+  boost::posix_time::ptime time = epoch + boost::posix_time::seconds(sec) + boost::posix_time::microseconds(usec);
+  return boost::posix_time::to_iso_extended_string(time);
+}
+
+TEST(TimestampTestSuite, isoTest)
+{
+  // Create test object
+  TimestampFormatter formatter;
+
+  // Matches boost across leap years, month ends and the fraction being left out when zero
+  int64_t seconds[] = {0, 951782399, 951782400, 1593754300, 1709251199, 4102444800};
+  uint32_t micros[] = {0, 1, 131383, 999999};
+  for (int64_t sec : seconds)
+  {
+    for (uint32_t usec : micros)
+    {
+      Timestamp stamp;
+      stamp.sec = sec;
+      stamp.usec = usec;
+      ASSERT_EQ(formatter.iso_string(stamp), boostIso(sec, usec));
+    }
+  }
+}
+
+TEST(TimestampTestSuite, cacheTest)
+{
+  // Create test object
+  TimestampFormatter formatter;
+  char buf[TimestampFormatter::ISO_SIZE];
+
+  // Same second patches only the fraction
+  Timestamp stamp;
+  stamp.sec = 1593754300;
+  stamp.usec = 131383;
+  size_t len = formatter.format_iso(stamp, buf);
+  ASSERT_EQ(std::string(buf, len), "2020-07-03T05:31:40.131383");
+  stamp.usec = 500;
+  len = formatter.format_iso(stamp, buf);
+  ASSERT_EQ(std::string(buf, len), "2020-07-03T05:31:40.000500");
+
+  // Going back in time refreshes the prefix
+  stamp.sec = 1593754299;
+  len = formatter.format_iso(stamp, buf);
+  ASSERT_EQ(std::string(buf, len), "2020-07-03T05:31:39.000500");
+}
+
+TEST(TimestampTestSuite, isoSecondsTest)
+{
+  // Create test object
+  TimestampFormatter formatter;
+  char buf[TimestampFormatter::ISO_SECONDS_SIZE];
+
+  // Matches the previous strftime format
+  time_t now = time(nullptr);
+  char expected[sizeof "2011-10-08T07:07:09Z"];
+  strftime(expected, sizeof expected, "%FT%TZ", gmtime(&now));
+
+  size_t len = formatter.format_iso_seconds(now, buf);
+  ASSERT_EQ(len, TimestampFormatter::ISO_SECONDS_SIZE);
+  ASSERT_EQ(std::string(buf, len), std::string(expected));
+}
+
+TEST(TimestampTestSuite, stampTest)
+{
+  // Header stamps keep microsecond precision
+  SampleStamp sample;
+  sample.sec = 1593754300;
+  sample.nsec = 131383999;
+  Timestamp stamp = Timestamp::from_stamp(sample);
+  ASSERT_EQ(stamp.sec, 1593754300);
+  ASSERT_EQ(stamp.usec, 131383);
+  ASSERT_EQ(TimestampFormatter::local().iso_string(stamp), "2020-07-03T05:31:40.131383");
+
+  // Wall time is close to the C library clock
+  ASSERT_LE(std::abs(Timestamp::now().sec - (int64_t)time(nullptr)), 1);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}